@@ -23,12 +23,21 @@
 
 #include <algorithm>
 #include <cstdlib>
+#include <cstring>
 #include <iostream>
 #include <iterator>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
 
 /************************************************************/
 // Local includes
 
+#include "ArrayAllocator.hpp"
+#include "ArraySimd.hpp"
+#include "../../common/MemoryUsage.hpp"
+
 /************************************************************/
 // Using declarations
 
@@ -42,10 +51,159 @@ using std::ptrdiff_t;
 
 /************************************************************/
 
+// Global heap usage of every Array (see MemoryUsage.hpp).
+inline MemoryAccounting::Counter&
+array_memory ()
+{
+  static MemoryAccounting::Counter counter ("Array");
+  return counter;
+}
+
+// Storage for the first "N" elements of an Array, kept inside the
+//   Array object itself so that small Arrays never touch the heap.
+// The buffer is raw memory: only the first "size" slots hold
+//   constructed objects. It is aligned like the heap storage.
+template<typename T, size_t N, size_t Align>
+struct ArrayInlineBuffer
+{
+  T* inline_data () {
+    return reinterpret_cast<T*> (m_inline);
+  }
+
+  const T* inline_data () const {
+    return reinterpret_cast<const T*> (m_inline);
+  }
+
+  alignas (Align) unsigned char m_inline[N * sizeof (T)];
+};
+
+// No inline storage: an Array<T> is exactly the classic heap Array.
+template<typename T, size_t Align>
+struct ArrayInlineBuffer<T, 0, Align>
+{
+  T* inline_data () {
+    return nullptr;
+  }
+
+  const T* inline_data () const {
+    return nullptr;
+  }
+};
+
+/************************************************************/
+
+// Move "count" elements from "from" into the raw storage at "to",
+//   leaving "from" as raw storage. The two ranges must not overlap.
+// Shared by Array and Deque.
 template<typename T>
+void
+array_relocate (T* from, size_t count, T* to)
+{
+  if (count == 0)
+    return;
+  if constexpr (std::is_trivially_copyable_v<T>) {
+    std::memcpy (static_cast<void*> (to), from, count * sizeof (T));
+  }
+  else if constexpr (std::is_nothrow_move_constructible_v<T>) {
+    for (size_t i = 0; i < count; ++i) {
+      ::new (static_cast<void*> (to + i)) T (std::move (from[i]));
+      std::destroy_at (from + i);
+    }
+  }
+  else {
+    // A throwing copy must leave "from" intact.
+    std::uninitialized_copy_n (from, count, to);
+    std::destroy_n (from, count);
+  }
+}
+
+/************************************************************/
+// Growth policies
+//
+// A growth policy picks the capacity an Array grows to when it
+//   runs out of room. "next_capacity" is given the current
+//   capacity, the capacity that is needed, and sizeof (T), and
+//   must return at least "required".
+
+// Double the capacity. The classic Array behavior.
+struct DoublingGrowth
+{
+  static size_t
+  next_capacity (size_t current, size_t required, size_t)
+  {
+    return std::max (required, current * 2);
+  }
+};
+
+// Grow by 1.5x. Blocks freed by earlier growth eventually add up
+//   to a later request, so the allocator can reuse them.
+struct HalfAgainGrowth
+{
+  static size_t
+  next_capacity (size_t current, size_t required, size_t)
+  {
+    return std::max (required, current + current / 2);
+  }
+};
+
+// Grow by (roughly) the golden ratio, 1.618x.
+struct GoldenGrowth
+{
+  static size_t
+  next_capacity (size_t current, size_t required, size_t)
+  {
+    return std::max (required, current + current * 618 / 1000);
+  }
+};
+
+// Grow like "Inner", but once the buffer spans at least a page,
+//   round it up to whole pages so large Arrays request sizes the
+//   allocator (and the kernel) can hand out without slack.
+template<typename Inner = DoublingGrowth, size_t PageSize = 4096>
+struct PageGrowth
+{
+  static size_t
+  next_capacity (size_t current, size_t required, size_t elemSize)
+  {
+    size_t space = Inner::next_capacity (current, required, elemSize);
+    size_t bytes = space * elemSize;
+    if (bytes < PageSize)
+      return space;
+    bytes = (bytes + PageSize - 1) / PageSize * PageSize;
+    return bytes / elemSize;
+  }
+};
+
+/************************************************************/
+
+// "N" is the inline capacity. Up to "N" elements are stored
+//   inside the Array itself; only beyond that does it spill to
+//   the heap. With N == 0 (the default) every element lives on
+//   the heap.
+//
+// Storage beyond "size" is left unconstructed, so growing
+//   costs one move (or one memcpy, for trivially copyable T)
+//   per live element and nothing for the spare capacity.
+//
+// "Growth" is the growth policy used by push_back and insert.
+// "Alloc" is the allocation policy (see ArrayAllocator.hpp) that
+//   provides the heap storage.
+// "Align" is the alignment of the storage, at least alignof (T).
+//   With 64 the buffer starts on a cache line and is padded to a
+//   whole number of lines, so numeric kernels can use aligned
+//   loads and Arrays owned by different threads never share a line.
+template<typename T, size_t N = 0, typename Growth = DoublingGrowth,
+         typename Alloc = HeapAllocator, size_t Align = alignof (T)>
 class Array
+  : private ArrayInlineBuffer<T, N, std::max (Align, alignof (T))>
 {
 public:
+  // The alignment of data ().
+  static constexpr size_t alignment = std::max (Align, alignof (T));
+
+  static_assert ((alignment & (alignment - 1)) == 0,
+                 "Array alignment must be a power of two");
+
   //*****************************************************
   // DO NOT MODIFY THIS SECTION!
   // Some standard Container type aliases
@@ -68,20 +226,22 @@ public:
   //   like I have below for the default ctor.
   Array ()
     : m_size (0),
-      m_capacity (0),
-      m_array (nullptr)
+      m_capacity (N),
+      m_array (this->inline_data ())
   {
   }
   
   // Size ctor.
   // Initialize an Array of size "pSize", with each element
   //   set to "value".
+  // NOTE: the remaining ctors delegate to the default ctor, so
+  //   the dtor releases the storage if an element ctor throws.
   explicit Array (size_t pSize, const T& value = T ())
-    : m_size (pSize),
-      m_capacity (pSize),
-      m_array (new T[m_capacity])
+    : Array ()
   {
-    fill (begin (), end (), value);
+    reserve (pSize);
+    std::uninitialized_fill_n (begin (), pSize, value);
+    m_size = pSize;
   }
 
   // Range ctor.
@@ -89,41 +249,77 @@ public:
   // "first" and "last" must be Array iterators or pointers
   //   into a primitive array.
   Array (const_iterator first, const_iterator last)
-  : m_size(std::distance(first, last)),
-    m_capacity(std::distance(first, last)),
-    m_array (new T[m_capacity])
+    : Array ()
   {
-    std::copy(first, last, begin());
+    reserve (distance (first, last));
+    std::uninitialized_copy (first, last, begin ());
+    m_size = distance (first, last);
   }
 
   // Copy ctor.
   // Initialize this object from "a".
   Array (const Array& a)
-  : m_size(a.size()),
-    m_capacity(a.capacity()),
-    m_array(new T[a.capacity()])
+    : Array ()
   {
-    std::copy(a.begin(), a.end(), begin());
+    reserve (a.capacity ());
+    std::uninitialized_copy (a.begin (), a.end (), begin ());
+    m_size = a.size ();
+  }
+
+  // Move ctor.
+  // Take over the storage of "a", leaving it empty.
+  //   Inline elements cannot be stolen, so they are relocated.
+  Array (Array&& a) noexcept (std::is_nothrow_move_constructible_v<T>)
+    : Array ()
+  {
+    steal (a);
   }
 
   // Destructor.
-  // Release allocated memory.
+  // Destroy the elements, then release allocated memory.
   ~Array () {
-    delete[] m_array;
+    clear ();
+    deallocate (m_array, m_capacity);
   }
 
   // Assignment operator.
   // Assign "a" to this object.
   //   Be careful to check for self-assignment.
+  // Elements that already exist are assigned to; only the
+  //   extra ones are constructed (or destroyed).
   Array& operator= (const Array& a) {
     if(&a != this) {
-      reserve(a.capacity());
-      std::copy(a.begin(), a.end(), begin());
+      if (a.capacity () > capacity ()) {
+        clear ();
+        reserve (a.capacity ());
+      }
+      if (a.size () <= size ()) {
+        std::copy (a.begin (), a.end (), begin ());
+        std::destroy (begin () + a.size (), end ());
+      }
+      else {
+        std::copy (a.begin (), a.begin () + size (), begin ());
+        std::uninitialized_copy (a.begin () + size (), a.end (), end ());
+      }
       m_size = a.size();
     }
     return *this;
   }
 
+  // Move assignment operator.
+  Array& operator= (Array&& a)
+    noexcept (std::is_nothrow_move_constructible_v<T>)
+  {
+    if (&a != this) {
+      clear ();
+      deallocate (m_array, m_capacity);
+      m_array = this->inline_data ();
+      m_capacity = N;
+      steal (a);
+    }
+    return *this;
+  }
+
   // Return the size.
   size_t size () const {
     return m_size;
@@ -150,23 +346,52 @@ public:
 
   // Insert an element at the back.
   void push_back (const T& item) {
-    if(capacity() == 0){
-      reserve(1);
+    emplace_back (item);
+  }
+
+  void push_back (T&& item) {
+    emplace_back (std::move (item));
+  }
+
+  // Construct an element in place at the back.
+  // If the capacity is insufficient, grow it as the growth
+  //   policy says (by default, DOUBLE it, or 0 to 1).
+  template<typename... Args>
+  reference emplace_back (Args&&... args) {
+    if(capacity() == size()) {
+      realloc_insert (grown_capacity (), size (),
+                      std::forward<Args> (args)...);
     }
-    else if(capacity() == size()) {
-        reserve(capacity() * 2);
+    else {
+      ::new (static_cast<void*> (end ())) T (std::forward<Args> (args)...);
+      ++m_size;
     }
-    *end() = item;
-    ++m_size;
+    return back ();
   }
 
   // Erase the element at the back.
   void pop_back () {
     if(size() != 0){
       --m_size;
+      std::destroy_at (end ());
     }
   }
 
+  // Return the element at the back.
+  reference back () {
+    return m_array[m_size - 1];
+  }
+
+  const_reference back () const {
+    return m_array[m_size - 1];
+  }
+
+  // Erase every element. The capacity is unchanged.
+  void clear () {
+    std::destroy (begin (), end ());
+    m_size = 0;
+  }
+
   // Reserve capacity for "space" elements.
   // "space" must be  greater than capacity.
   //   If not, leave the capacity unchanged.
@@ -175,11 +400,19 @@ public:
   {
     if (space > capacity ())
     {
-      T* array = new T[space];
-      copy (begin (), end (), array);
-      delete[] m_array;
-      m_array = array;
-      m_capacity = space;
+      reallocate (space);
+    }
+  }
+
+  // Reduce the capacity to the size (or to the inline capacity,
+  //   whichever is larger), releasing the spare memory.
+  // Elements that spilled to the heap move back inline if they fit.
+  void shrink_to_fit ()
+  {
+    size_t space = std::max (size (), N);
+    if (space < capacity ())
+    {
+      reallocate (space);
     }
   }
 
@@ -191,38 +424,117 @@ public:
   void resize (size_t newSize, const T& value = T ()) {
     if(newSize > size()) {
       reserve(newSize);
-      std::fill(end(), (end() + (newSize - size())), value);
+      std::uninitialized_fill (end (), begin () + newSize, value);
+    }
+    else {
+      std::destroy (begin () + newSize, end ());
     }
     m_size = newSize;
   }
   
 
   // Insert "item" before "pos", and return iterator pointing to "item".
-  // If the capacity is insufficient, DOUBLE it.
-  //   If the capacity is 0, increase it to 1.
+  // If the capacity is insufficient, grow it as push_back does.
   // NOTE: If a reallocation occurs, "pos" will be invalidated!
   iterator insert (iterator pos, const T& item) {
+    return emplace (pos, item);
+  }
+
+  iterator insert (iterator pos, T&& item) {
+    return emplace (pos, std::move (item));
+  }
+
+  // Construct an element in place before "pos", and return an
+  //   iterator pointing to it.
+  template<typename... Args>
+  iterator emplace (iterator pos, Args&&... args) {
+    size_t index = distance (begin (), pos);
     if(capacity() == size()) {
-      auto index = distance(begin(), pos);
-      reserve(capacity() * 2 + 1);
-      pos = begin() + index;
+      // The new element and the two halves around it go straight
+      //   into the new storage: no separate shifting pass.
+      realloc_insert (grown_capacity (), index,
+                      std::forward<Args> (args)...);
+    }
+    else if (index == size ()) {
+      ::new (static_cast<void*> (end ())) T (std::forward<Args> (args)...);
+      ++m_size;
     }
+    else {
+      // Build the value first: "args" may refer into this Array.
+      T item (std::forward<Args> (args)...);
+      ::new (static_cast<void*> (end ())) T (std::move (back ()));
+      std::move_backward (pos, end () - 1, end ());
+      *pos = std::move (item);
+      ++m_size;
+    }
+    return begin () + index;
+  }
 
-    std::copy_backward(pos, end(), end()+ 1);
-    *pos = item;
-    ++m_size;
+  // Insert "count" copies of "value" before "pos", and return an
+  //   iterator pointing to the first of them (or "pos" if none).
+  // The elements after "pos" are shifted once, not once per copy.
+  // NOTE: If a reallocation occurs, "pos" will be invalidated!
+  iterator insert (iterator pos, size_t count, const T& value) {
+    size_t index = distance (begin (), pos);
+    if (count == 0)
+      return pos;
+    if (size () + count > capacity ())
+      // "value" lives until the old storage goes away.
+      return insert_n (index, count, RepeatIterator {&value});
+    // The shift may overwrite "value" if it is one of our elements.
+    T item (value);
+    return insert_n (index, count, RepeatIterator {&item});
+  }
 
-    return pos;
+  // Insert the elements of [first, last) before "pos", and return
+  //   an iterator pointing to the first of them (or "pos" if none).
+  // The range must not refer into this Array.
+  // NOTE: If a reallocation occurs, "pos" will be invalidated!
+  template<typename InputIt,
+           typename Category =
+             typename std::iterator_traits<InputIt>::iterator_category>
+  iterator insert (iterator pos, InputIt first, InputIt last) {
+    size_t index = distance (begin (), pos);
+    if constexpr (std::is_base_of_v<std::forward_iterator_tag, Category>) {
+      return insert_n (index, std::distance (first, last), first);
+    }
+    else {
+      // A single-pass range can't be counted up front, so collect it.
+      Array<T> items;
+      for (; first != last; ++first)
+        items.emplace_back (*first);
+      return insert_n (index, items.size (),
+                       std::make_move_iterator (items.begin ()));
+    }
   }
 
   // Remove element at "pos", and return an iterator
   //   referencing the next element.
   iterator erase (iterator pos) {
-    std::copy(pos + 1, end(), pos);
-    --m_size;
+    std::move (pos + 1, end (), pos);
+    pop_back ();
     return pos;
   }
 
+  // Remove the elements of [first, last), and return an iterator
+  //   referencing the element after them.
+  // The tail is moved down once, however many elements go.
+  iterator erase (iterator first, iterator last) {
+    if (first != last)
+      truncate (std::move (last, end (), first));
+    return first;
+  }
+
+  // Remove every element "x" for which "pred (x)" is true, keeping
+  //   the order of the rest, and return how many were removed.
+  // Each survivor is moved at most once.
+  template<typename Predicate>
+  size_t erase_if (Predicate pred) {
+    size_t oldSize = size ();
+    truncate (std::remove_if (begin (), end (), pred));
+    return oldSize - size ();
+  }
+
   // Return iterator pointing to the first element.
   iterator begin () {
     return m_array;
@@ -251,24 +563,294 @@ public:
     return m_array;
   }
 
+  // Return data (), telling the compiler it is aligned to
+  //   "alignment" bytes so it may use aligned vector loads.
+  T* assume_aligned () {
+    return static_cast<T*> (__builtin_assume_aligned (m_array, alignment));
+  }
+
+  T const* assume_aligned () const {
+    return static_cast<T const*> (
+      __builtin_assume_aligned (m_array, alignment));
+  }
+
+  // Bulk operations. For int and float these run AVX2 or AVX-512
+  //   kernels when the CPU has them (see ArraySimd.hpp).
+
+  // Return an iterator to the first element equal to "value",
+  //   or end () if there is none.
+  iterator find (const T& value) {
+    return begin () + ArraySimd::find (data (), size (), value);
+  }
+
+  const_iterator find (const T& value) const {
+    return begin () + ArraySimd::find (data (), size (), value);
+  }
+
+  // Return the number of elements equal to "value".
+  size_t count (const T& value) const {
+    return ArraySimd::count (data (), size (), value);
+  }
+
+  // Return the smallest element. The Array must not be empty.
+  T min () const {
+    return ArraySimd::min (data (), size ());
+  }
+
+  // Return the largest element. The Array must not be empty.
+  T max () const {
+    return ArraySimd::max (data (), size ());
+  }
+
+  // Return the sum of the elements (T () if empty).
+  //   Float sums are reassociated, so the last bits may differ
+  //   from a left-to-right loop.
+  T sum () const {
+    return ArraySimd::sum (data (), size ());
+  }
+
+  // Replace each element "x" with "op (x)".
+  template<typename UnaryOp>
+  void transform (UnaryOp op) {
+    ArraySimd::transform (data (), size (), op);
+  }
+
+  // Return the heap this Array holds. The inline buffer is part of
+  //   the object, so it never counts.
+  MemoryUsage memory_usage () const {
+    if (m_array == nullptr || is_inline ())
+      return {};
+    return { storage_bytes (m_capacity), 1 };
+  }
+
+  // Return true if the elements live in the inline buffer.
+  bool is_inline () const {
+    return N != 0 && m_array == this->inline_data ();
+  }
+
 private:
+  // Return the capacity to grow to when one more element is needed.
+  size_t grown_capacity () const {
+    return Growth::next_capacity (capacity (), size () + 1, sizeof (T));
+  }
+
+  // Return the bytes of heap storage for "space" elements. An
+  //   over-aligned buffer is padded to a multiple of its alignment,
+  //   so nothing else is allocated in its last cache line.
+  static size_t storage_bytes (size_t space) {
+    size_t bytes = space * sizeof (T);
+    if (alignment > alignof (T))
+      bytes = (bytes + alignment - 1) / alignment * alignment;
+    return bytes;
+  }
+
+  // Return raw storage for "space" elements: the inline buffer if
+  //   it is large enough, the heap otherwise.
+  T* allocate (size_t space) {
+    if (space <= N)
+      return this->inline_data ();
+    T* array = static_cast<T*> (Alloc::allocate (storage_bytes (space),
+                                                 alignment));
+    MemoryAccounting::allocated<array_memory> (storage_bytes (space));
+    return array;
+  }
+
+  // Release raw storage obtained from "allocate", unless it is
+  //   the inline buffer.
+  void deallocate (T* array, size_t space) {
+    if (array == nullptr || array == this->inline_data ())
+      return;
+    MemoryAccounting::released<array_memory> (storage_bytes (space));
+    Alloc::deallocate (array, storage_bytes (space), alignment);
+  }
+
+  // Move the elements into new storage for "space" elements.
+  // When the elements may be moved bitwise, first let the
+  //   allocation policy resize the block without copying.
+  void reallocate (size_t space) {
+    T* array = nullptr;
+    if constexpr (std::is_trivially_copyable_v<T>) {
+      if (m_array != nullptr && !is_inline () && space > N)
+        array = static_cast<T*> (Alloc::reallocate (
+          m_array, storage_bytes (m_capacity), storage_bytes (space),
+          alignment));
+      if (array != nullptr) {
+        MemoryAccounting::released<array_memory> (storage_bytes (m_capacity));
+        MemoryAccounting::allocated<array_memory> (storage_bytes (space));
+      }
+    }
+    if (array == nullptr) {
+      array = allocate (space);
+      array_relocate (begin (), size (), array);
+      deallocate (m_array, m_capacity);
+    }
+    m_array = array;
+    m_capacity = space;
+  }
+
+  // Grow to "space" elements, constructing a new element from
+  //   "args" at "index" and relocating the old elements around it.
+  template<typename... Args>
+  void realloc_insert (size_t space, size_t index, Args&&... args) {
+    if constexpr (std::is_trivially_copyable_v<T>) {
+      if (index == size ()) {
+        // Appending: grow through "reallocate" so the block can be
+        //   remapped. "args" may refer into this Array, so build
+        //   the value before the old block goes away.
+        T item (std::forward<Args> (args)...);
+        reallocate (space);
+        ::new (static_cast<void*> (end ())) T (item);
+        ++m_size;
+        return;
+      }
+    }
+    T* array = allocate (space);
+    try {
+      ::new (static_cast<void*> (array + index))
+        T (std::forward<Args> (args)...);
+    }
+    catch (...) {
+      deallocate (array, space);
+      throw;
+    }
+    array_relocate (begin (), index, array);
+    array_relocate (begin () + index, size () - index, array + index + 1);
+    deallocate (m_array, m_capacity);
+    m_array = array;
+    m_capacity = space;
+    ++m_size;
+  }
+
+  // Insert "count" elements, copied from the range starting at
+  //   "first", before "index".
+  template<typename ForwardIt>
+  iterator insert_n (size_t index, size_t count, ForwardIt first) {
+    if (count == 0)
+      return begin () + index;
+    if (size () + count > capacity ()) {
+      // Build the new elements in the new storage, then relocate the
+      //   two halves around them: no separate shifting pass.
+      size_t space = Growth::next_capacity (capacity (), size () + count,
+                                            sizeof (T));
+      T* array = allocate (space);
+      try {
+        std::uninitialized_copy_n (first, count, array + index);
+      }
+      catch (...) {
+        deallocate (array, space);
+        throw;
+      }
+      array_relocate (begin (), index, array);
+      array_relocate (begin () + index, size () - index, array + index + count);
+      deallocate (m_array, m_capacity);
+      m_array = array;
+      m_capacity = space;
+      m_size += count;
+      return begin () + index;
+    }
+    iterator pos = begin () + index;
+    size_t after = size () - index;
+    if constexpr (std::is_trivially_copyable_v<T>) {
+      std::memmove (static_cast<void*> (pos + count), pos, after * sizeof (T));
+      std::uninitialized_copy_n (first, count, pos);
+      m_size += count;
+    }
+    else if (after > count) {
+      // The last "count" elements move into raw storage, the rest
+      //   of the tail is moved up over live elements.
+      iterator oldEnd = end ();
+      std::uninitialized_move (oldEnd - count, oldEnd, oldEnd);
+      m_size += count;
+      std::move_backward (pos, oldEnd - count, oldEnd);
+      std::copy_n (first, count, pos);
+    }
+    else {
+      // The new elements reach past the old end: construct those
+      //   first, then move the whole tail into raw storage.
+      ForwardIt mid = std::next (first, after);
+      std::uninitialized_copy_n (mid, count - after, end ());
+      m_size += count - after;
+      std::uninitialized_move (pos, pos + after, end ());
+      m_size += after;
+      std::copy_n (first, after, pos);
+    }
+    return pos;
+  }
+
+  // Destroy the elements from "newEnd" on.
+  void truncate (iterator newEnd) {
+    std::destroy (newEnd, end ());
+    m_size = distance (begin (), newEnd);
+  }
+
+  // Forward iterator that yields the same value forever, so filling
+  //   "count" copies can share the range insertion code.
+  // Any two compare equal: use it only with counted (_n) algorithms.
+  struct RepeatIterator
+  {
+    using value_type = T;
+    using pointer = const T*;
+    using reference = const T&;
+    using difference_type = ptrdiff_t;
+    using iterator_category = std::forward_iterator_tag;
+
+    reference operator* () const { return *m_value; }
+    RepeatIterator& operator++ () { return *this; }
+    RepeatIterator operator++ (int) { return *this; }
+    friend bool operator== (RepeatIterator, RepeatIterator) { return true; }
+    friend bool operator!= (RepeatIterator, RepeatIterator) { return false; }
+
+    const T* m_value;
+  };
+
+  // Take the elements of "a", which must be empty with no storage
+  //   of our own, leaving "a" empty.
+  void steal (Array& a) {
+    if (a.is_inline ()) {
+      array_relocate (a.begin (), a.size (), begin ());
+    }
+    else {
+      m_array = a.m_array;
+      m_capacity = a.m_capacity;
+      a.m_array = a.inline_data ();
+      a.m_capacity = N;
+    }
+    m_size = a.m_size;
+    a.m_size = 0;
+  }
+
   // Stores the number of elements in the Array.
   size_t m_size;
   // Stores the capacity of the Array, which must be at least "m_size".
   size_t m_capacity;
   // Stores a pointer to the first element in the Array.
+  //   Points into the inline buffer while size <= N.
   T* m_array;
 };
 
+// An Array that keeps up to "N" elements inline.
+template<typename T, size_t N, typename Growth = DoublingGrowth>
+using SmallArray = Array<T, N, Growth>;
+
+// An Array for very large buffers: mmap-backed once it reaches
+//   1 MiB, grown page by page with mremap instead of copies.
+template<typename T, HugePages Pages = HugePages::None>
+using MappedArray = Array<T, 0, PageGrowth<>, MmapAllocator<Pages>>;
+
+// An Array whose storage is aligned to "Align" bytes (a cache
+//   line, by default).
+template<typename T, size_t Align = 64>
+using AlignedArray = Array<T, 0, DoublingGrowth, HeapAllocator, Align>;
+
 /************************************************************************/
 // Free functions associated with the class
 
 // Output operator.
 // Allows us to do "cout << a;", where "a" is an Array.
 // DO NOT MODIFY!
-template<typename T>
+template<typename T, size_t N, typename Growth, typename Alloc, size_t Align>
 ostream&
-operator<< (ostream& output, const Array<T>& a)
+operator<< (ostream& output, const Array<T, N, Growth, Alloc, Align>& a)
 {
   output << "[ ";
   // This for-each loop will employ iterators.
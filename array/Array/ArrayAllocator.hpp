@@ -0,0 +1,191 @@
+/*
+  Filename   : ArrayAllocator.hpp
+  Author     : Joshua Carney
+  Course     : CSCI 362
+  Assignment : N/A
+  Description: Allocation policies for the Array class.
+
+                 An allocation policy hands out raw, uninitialized
+                 bytes. Array constructs and destroys the elements
+                 itself. Every policy provides three static members:
+
+                   allocate   (bytes, align)
+                   deallocate (p, bytes, align)
+                   reallocate (p, oldBytes, newBytes, align)
+
+                 "reallocate" may resize the block without copying
+                 and returns nullptr when it cannot. Array only asks
+                 for it when a bitwise move of its elements is valid.
+*/
+
+/************************************************************/
+// Macro guard to prevent multiple inclusions
+
+#ifndef ARRAY_ALLOCATOR_H
+#define ARRAY_ALLOCATOR_H
+
+/************************************************************/
+// System includes
+
+#include <cstdlib>
+#include <new>
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+/************************************************************/
+
+// Plain operator new / operator delete.
+struct HeapAllocator
+{
+  static void*
+  allocate (size_t bytes, size_t align)
+  {
+    if (align > __STDCPP_DEFAULT_NEW_ALIGNMENT__)
+      return ::operator new (bytes, std::align_val_t (align));
+    return ::operator new (bytes);
+  }
+
+  static void
+  deallocate (void* p, size_t bytes, size_t align)
+  {
+    if (align > __STDCPP_DEFAULT_NEW_ALIGNMENT__)
+      ::operator delete (p, bytes, std::align_val_t (align));
+    else
+      ::operator delete (p, bytes);
+  }
+
+  static void*
+  reallocate (void*, size_t, size_t, size_t)
+  {
+    return nullptr;
+  }
+};
+
+/************************************************************/
+
+// How an MmapAllocator asks for huge pages.
+enum class HugePages
+{
+  // 4K pages only.
+  None,
+  // madvise (MADV_HUGEPAGE): let the kernel back the mapping with
+  //   transparent huge pages when it can.
+  Transparent,
+  // MAP_HUGETLB from the reserved huge page pool, falling back to
+  //   Transparent when the pool is empty.
+  Explicit
+};
+
+// Back large blocks with anonymous mmap and grow them with mremap,
+//   which moves page table entries instead of copying the data.
+// Blocks smaller than "Threshold" bytes come from HeapAllocator.
+// A block's size decides where it came from, so a block is always
+//   returned to the same place it was taken from.
+// On systems without mmap this is just HeapAllocator.
+template<HugePages Pages = HugePages::None, size_t Threshold = (1 << 20)>
+struct MmapAllocator
+{
+  static void*
+  allocate (size_t bytes, size_t align)
+  {
+#if defined(__linux__)
+    if (mapped (bytes) && align <= page_size ())
+    {
+      void* p = MAP_FAILED;
+      size_t length = mapped_length (bytes);
+      if (Pages == HugePages::Explicit)
+        p = ::mmap (nullptr, length, PROT_READ | PROT_WRITE,
+                    MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+      if (p == MAP_FAILED)
+      {
+        p = ::mmap (nullptr, length, PROT_READ | PROT_WRITE,
+                    MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (p == MAP_FAILED)
+          throw std::bad_alloc ();
+        advise (p, length);
+      }
+      return p;
+    }
+#endif
+    return HeapAllocator::allocate (bytes, align);
+  }
+
+  static void
+  deallocate (void* p, size_t bytes, size_t align)
+  {
+#if defined(__linux__)
+    if (mapped (bytes) && align <= page_size ())
+    {
+      ::munmap (p, mapped_length (bytes));
+      return;
+    }
+#endif
+    HeapAllocator::deallocate (p, bytes, align);
+  }
+
+  // Resize a mapped block in place, or let the kernel move it.
+  // Returns nullptr unless both the old and the new block are mapped.
+  static void*
+  reallocate (void* p, size_t oldBytes, size_t newBytes, size_t align)
+  {
+#if defined(__linux__)
+    if (mapped (oldBytes) && mapped (newBytes) && align <= page_size ())
+    {
+      size_t oldLength = mapped_length (oldBytes);
+      size_t newLength = mapped_length (newBytes);
+      if (oldLength == newLength)
+        return p;
+      void* q = ::mremap (p, oldLength, newLength, MREMAP_MAYMOVE);
+      if (q == MAP_FAILED)
+        return nullptr;
+      if (newLength > oldLength)
+        advise (q, newLength);
+      return q;
+    }
+#endif
+    return nullptr;
+  }
+
+private:
+#if defined(__linux__)
+  static bool
+  mapped (size_t bytes)
+  {
+    return bytes >= Threshold;
+  }
+
+  static size_t
+  page_size ()
+  {
+    static const size_t size = ::sysconf (_SC_PAGESIZE);
+    return size;
+  }
+
+  // Round up to whole pages. With huge pages, round to 2 MiB so a
+  //   hugetlb mapping is unmapped with the length it was given.
+  static size_t
+  mapped_length (size_t bytes)
+  {
+    size_t page = Pages == HugePages::None ? page_size () : (1 << 21);
+    return (bytes + page - 1) / page * page;
+  }
+
+  static void
+  advise (void* p, size_t length)
+  {
+#if defined(MADV_HUGEPAGE)
+    if (Pages != HugePages::None)
+      ::madvise (p, length, MADV_HUGEPAGE);
+#endif
+  }
+#endif
+};
+
+/************************************************************/
+
+#endif
+
+/************************************************************/
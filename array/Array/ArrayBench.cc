@@ -0,0 +1,154 @@
+/*
+  Filename   : ArrayBench.cc
+  Author     : Joshua Carney
+  Course     : CSCI 362
+  Assignment : N/A
+  Description: Time the Array bulk operations (find, count, min,
+               max, sum, transform) on each instruction set the CPU
+               supports, and report the speedup over the scalar loops.
+
+               Usage: ArrayBench [elements]
+*/   
+
+/************************************************************/
+// System includes
+
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+/************************************************************/
+// Local includes
+
+#include "Array.hpp"
+
+/************************************************************/
+// Using declarations
+
+using std::cout;
+using std::endl;
+using std::setw;
+using std::string;
+
+using ArraySimd::Isa;
+
+/************************************************************/
+// Function prototypes/global vars/typedefs
+
+// Results are written here so the timed calls cannot be optimized away
+volatile double g_sink;
+
+// Return the best time, in ms, of "reps" runs of "f"
+template<typename F>
+double
+bestOf (int reps, F f);
+
+// Same, but call "reset" before each run, untimed
+template<typename Reset, typename F>
+double
+bestOf (int reps, Reset reset, F f);
+
+// Time every bulk operation on "a" for each instruction set
+template<typename T>
+void
+benchType (const string& name, Array<T>& a);
+
+/************************************************************/
+
+int      
+main (int argc, char* argv[]) 
+{        
+  size_t n = argc > 1 ? std::stoul (argv[1]) : (1u << 24);
+
+  Array<int> ints;
+  Array<float> floats;
+  ints.reserve (n);
+  floats.reserve (n);
+  for (size_t i = 0; i < n; ++i)
+  {
+    ints.push_back (static_cast<int> ((i * 2654435761u) % 1000000));
+    floats.push_back (static_cast<float> (i % 1000) * 0.25f);
+  }
+
+  cout << n << " elements, times in ms (best of 5)" << endl << endl;
+  benchType ("int", ints);
+  benchType ("float", floats);
+  
+  return EXIT_SUCCESS;
+}
+
+/************************************************************/
+
+template<typename F>
+double
+bestOf (int reps, F f)
+{
+  return bestOf (reps, [] {}, f);
+}
+
+template<typename Reset, typename F>
+double
+bestOf (int reps, Reset reset, F f)
+{
+  double best = 1e300;
+  for (int r = 0; r < reps; ++r)
+  {
+    reset ();
+    auto start = std::chrono::steady_clock::now ();
+    f ();
+    auto stop = std::chrono::steady_clock::now ();
+    best = std::min (
+      best, std::chrono::duration<double, std::milli> (stop - start).count ());
+  }
+  return best;
+}
+
+/************************************************************/
+
+template<typename T>
+void
+benchType (const string& name, Array<T>& a)
+{
+  const char* isaNames[] = { "scalar", "avx2", "avx512" };
+  const char* ops[] = { "find", "count", "min", "max", "sum", "transform" };
+  const int numOps = 6;
+  double times[3][numOps] = {};
+
+  Isa best = ArraySimd::detect_isa ();
+  for (int isa = 0; isa <= static_cast<int> (best); ++isa)
+  {
+    ArraySimd::set_isa (static_cast<Isa> (isa));
+    // find is timed on a miss, so it scans the whole Array
+    times[isa][0] = bestOf (5, [&] { g_sink = a.find (T (-1)) - a.begin (); });
+    times[isa][1] = bestOf (5, [&] { g_sink = a.count (T (0)); });
+    times[isa][2] = bestOf (5, [&] { g_sink = a.min (); });
+    times[isa][3] = bestOf (5, [&] { g_sink = a.max (); });
+    times[isa][4] = bestOf (5, [&] { g_sink = a.sum (); });
+    // transform a fresh copy each time: transforming "a" over and over
+    //   would overflow, and leave every instruction set different data
+    Array<T> work;
+    times[isa][5] = bestOf (5, [&] { work = a; }, [&] {
+      work.transform ([] (T x) { return x * T (3) + T (1); });
+    });
+  }
+  ArraySimd::set_isa (best);
+
+  cout << name << endl;
+  cout << setw (10) << "op";
+  for (int isa = 0; isa <= static_cast<int> (best); ++isa)
+    cout << setw (10) << isaNames[isa];
+  cout << setw (10) << "speedup" << endl;
+  for (int op = 0; op < numOps; ++op)
+  {
+    cout << setw (10) << ops[op] << std::fixed << std::setprecision (3);
+    for (int isa = 0; isa <= static_cast<int> (best); ++isa)
+      cout << setw (10) << times[isa][op];
+    cout << std::setprecision (1) << setw (9)
+         << times[0][op] / times[static_cast<int> (best)][op] << "x" << endl;
+  }
+  cout << endl;
+}
+
+/************************************************************/
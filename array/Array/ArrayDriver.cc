@@ -9,6 +9,7 @@
 /************************************************************/
 // System includes
 
+#include <cstdint>
 #include <cstdlib>
 #include <iostream>
 #include <string>
@@ -27,13 +28,31 @@
 using std::cin;
 using std::cout;
 using std::endl;
+using std::istream_iterator;
 using std::ostream_iterator;
 using std::string;
+using std::istringstream;
 using std::ostringstream;
 
 /************************************************************/
 // Function prototypes/global vars/typedefs
 
+// Counts how many objects are alive, to check that spare
+//   capacity is never constructed
+struct Tracked
+{
+  static int live;
+
+  Tracked (int v = 0) : value (v) { ++live; }
+  Tracked (const Tracked& t) : value (t.value) { ++live; }
+  Tracked& operator= (const Tracked&) = default;
+  ~Tracked () { --live; }
+
+  int value;
+};
+
+int Tracked::live = 0;
+
 void
 printTestResult (const string& test,
 		 const string& expected,
@@ -128,6 +147,166 @@ main (int argc, char* argv[])
 
   // Test capacity
 
+  // SmallArray keeps its first N elements inside the object
+  SmallArray<int, 4> S;
+  for (int i = 0; i < 4; ++i)
+    S.push_back (i);
+
+  output.str ("");
+  output << S << " " << S.capacity () << " " << S.is_inline ();
+  printTestResult ("SmallArray inline", "[ 0 1 2 3 ] 4 1", output);
+
+  S.push_back (4);
+  SmallArray<int, 4> T (S);
+
+  output.str ("");
+  output << T << " " << T.capacity () << " " << T.is_inline ();
+  printTestResult ("SmallArray spill", "[ 0 1 2 3 4 ] 8 0", output);
+
+  {
+    // Only live elements are constructed, growth and moves
+    //   never add or lose an object
+    Array<Tracked> D;
+    D.reserve (64);
+    for (int i = 0; i < 100; ++i)
+      D.push_back (Tracked (i));
+    D.insert (D.begin (), D[99]);
+    D.erase (D.begin () + 50);
+    D.resize (10);
+    Array<Tracked> E (std::move (D));
+
+    output.str ("");
+    output << Tracked::live << " " << D.size () << " " << E[0].value
+           << " " << E[9].value;
+    printTestResult ("uninitialized storage", "10 0 99 8", output);
+
+    SmallArray<string, 2> F;
+    F.push_back ("a");
+    F.push_back ("b");
+    SmallArray<string, 2> G;
+    G = std::move (F);
+    G.push_back ("c");
+
+    output.str ("");
+    output << G << " " << F.size ();
+    printTestResult ("move inline", "[ a b c ] 0", output);
+  }
+
+  output.str ("");
+  output << Tracked::live;
+  printTestResult ("no leaked objects", "0", output);
+
+  // Growth policies and shrink_to_fit
+  Array<int, 0, HalfAgainGrowth> H;
+  for (int i = 0; i < 5; ++i)
+    H.push_back (i);
+  Array<char, 0, PageGrowth<>> P (4000, 'x');
+  P.push_back ('y');
+
+  output.str ("");
+  output << H.capacity () << " " << P.capacity ();
+  printTestResult ("growth policy", "6 8192", output);
+
+  H.pop_back ();
+  H.shrink_to_fit ();
+  S.shrink_to_fit ();
+  S.pop_back ();
+  S.shrink_to_fit ();
+
+  output.str ("");
+  output << H << " " << H.capacity () << " " << S.capacity () << " "
+         << S.is_inline ();
+  printTestResult ("shrink_to_fit", "[ 0 1 2 3 ] 4 4 1", output);
+
+  // mmap-backed storage, grown and shrunk across the 1 MiB threshold
+  MappedArray<int> M;
+  for (int i = 0; i < 1000000; ++i)
+    M.push_back (i);
+  long long mSum = 0;
+  for (int v : M)
+    mSum += v;
+  M.resize (10);
+  M.shrink_to_fit ();
+
+  output.str ("");
+  output << mSum << " " << M.size () << " " << M[9];
+  printTestResult ("MappedArray", "499999500000 10 9", output);
+
+  // Bulk operations give the same answers on every instruction set
+  for (auto isa : { ArraySimd::Isa::Scalar, ArraySimd::Isa::Avx2,
+                    ArraySimd::Isa::Avx512 })
+  {
+    ArraySimd::set_isa (isa);
+    Array<int> I;
+    Array<float> F;
+    for (int i = 0; i < 37; ++i)
+    {
+      I.push_back ((i * 7) % 37 - 18);
+      F.push_back (i * 0.5f);
+    }
+    I.transform ([] (int x) { return x * 2; });
+
+    output.str ("");
+    output << (I.find (36) - I.begin ()) << " " << (I.find (5) == I.end ())
+           << " " << I.count (0) << " " << I.min () << " " << I.max () << " "
+           << I.sum () << " " << (F.find (18.0f) - F.begin ()) << " "
+           << F.count (3.0f) << " " << F.min () << " " << F.max () << " "
+           << F.sum ();
+    printTestResult ("bulk operations", "21 1 1 -36 36 0 36 1 0 18 333", output);
+  }
+  ArraySimd::set_isa (ArraySimd::detect_isa ());
+
+  // Aligned storage, on the heap and inline
+  AlignedArray<float> L (3, 1.5f);
+  for (int i = 0; i < 100; ++i)
+    L.push_back (2.0f);
+  Array<double, 4, DoublingGrowth, HeapAllocator, 32> K (2, 0.5);
+
+  output.str ("");
+  output << reinterpret_cast<uintptr_t> (L.assume_aligned ()) % 64 << " "
+         << reinterpret_cast<uintptr_t> (K.data ()) % 32 << " "
+         << K.is_inline () << " " << L.sum ();
+  printTestResult ("aligned storage", "0 0 1 204.5", output);
+
+  // Batch insert and erase
+  int digits[] = { 7, 8, 9 };
+  Array<int> R (4, 0);
+  R.reserve (16);
+  R.insert (R.begin () + 1, digits, digits + 3);
+  R.insert (R.end () - 1, 2, 5);
+  R.insert (R.begin (), 3, R[1]);
+  R.insert (R.begin () + 2, R.size () * 2, 1);
+
+  output.str ("");
+  output << R.size () << " " << R.capacity () << " " << R.count (1) << " "
+         << R[0] << R[1] << R[25] << R[26] << R[30] << R[31] << R[32];
+  printTestResult ("batch insert", "36 36 24 7717900", output);
+
+  istringstream words ("c d e");
+  Array<string> W (3, "a");
+  W.reserve (10);
+  W.insert (W.begin () + 1, 4, "b");
+  W.insert (W.begin () + 2, istream_iterator<string> (words),
+            istream_iterator<string> ());
+  W.erase (W.begin () + 2, W.begin () + 4);
+  W.erase_if ([] (const string& s) { return s == "b"; });
+
+  output.str ("");
+  output << W << " " << W.capacity ();
+  printTestResult ("batch insert strings", "[ a e a a ] 10", output);
+
+  output.str ("");
+  output << R.erase_if ([] (int x) { return x == 1; }) << " "
+         << *R.erase (R.begin () + 1, R.begin () + 3) << " " << R
+         << " " << (R.erase (R.end (), R.end ()) == R.end ());
+  printTestResult ("erase_if", "24 0 [ 7 0 7 8 9 0 0 5 5 0 ] 1", output);
+
+  // Heap held: only heap storage counts, never the inline buffer
+  output.str ("");
+  output << R.memory_usage ().bytes << " " << R.memory_usage ().allocations
+         << " " << S.memory_usage ().bytes << " " << A.memory_usage ().bytes;
+  printTestResult ("memory_usage", "144 1 0 64", output);
+
   // ...
   
   return EXIT_SUCCESS;
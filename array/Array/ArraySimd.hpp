@@ -0,0 +1,578 @@
+/*
+  Filename   : ArraySimd.hpp
+  Author     : Joshua Carney
+  Course     : CSCI 362
+  Assignment : N/A
+  Description: Vectorized bulk operations used by the Array class.
+
+                 Every operation works on a contiguous range
+                 [p, p + n). For int and float there are AVX2 and
+                 AVX-512 kernels. Which one runs is decided once, at
+                 run time, from what the CPU supports, so the same
+                 binary runs everywhere. Other types, and other CPUs,
+                 use the plain scalar loops.
+*/
+
+/************************************************************/
+// Macro guard to prevent multiple inclusions
+
+#ifndef ARRAY_SIMD_H
+#define ARRAY_SIMD_H
+
+/************************************************************/
+// System includes
+
+#include <algorithm>
+#include <cstdlib>
+#include <type_traits>
+
+/************************************************************/
+// Local includes
+
+#include "../../common/SimdIsa.hpp"
+
+/************************************************************/
+
+namespace ArraySimd
+{
+
+// The instruction set selection is shared with the other modules.
+using SimdIsa::Isa;
+using SimdIsa::detect_isa;
+using SimdIsa::active_isa;
+using SimdIsa::set_isa;
+
+// Types that have vector kernels.
+template<typename T>
+constexpr bool has_kernels =
+  SIMD_ISA_X86 && (std::is_same_v<T, int> || std::is_same_v<T, float>);
+
+/************************************************************/
+// Scalar kernels, for any T
+
+template<typename T>
+size_t
+find_scalar (const T* p, size_t n, const T& value)
+{
+  for (size_t i = 0; i < n; ++i)
+    if (p[i] == value)
+      return i;
+  return n;
+}
+
+template<typename T>
+size_t
+count_scalar (const T* p, size_t n, const T& value)
+{
+  size_t count = 0;
+  for (size_t i = 0; i < n; ++i)
+    if (p[i] == value)
+      ++count;
+  return count;
+}
+
+// NOTE: min and max need n > 0
+template<typename T>
+T
+min_scalar (const T* p, size_t n)
+{
+  T m = p[0];
+  for (size_t i = 1; i < n; ++i)
+    if (p[i] < m)
+      m = p[i];
+  return m;
+}
+
+template<typename T>
+T
+max_scalar (const T* p, size_t n)
+{
+  T m = p[0];
+  for (size_t i = 1; i < n; ++i)
+    if (m < p[i])
+      m = p[i];
+  return m;
+}
+
+// Integer sums wrap around, as the vector kernels' do.
+template<typename T>
+T
+sum_scalar (const T* p, size_t n)
+{
+  if constexpr (std::is_integral_v<T> && !std::is_same_v<T, bool>)
+  {
+    using U = std::make_unsigned_t<T>;
+    U s = U ();
+    for (size_t i = 0; i < n; ++i)
+      s += static_cast<U> (p[i]);
+    return static_cast<T> (s);
+  }
+  else
+  {
+    T s = T ();
+    for (size_t i = 0; i < n; ++i)
+      s += p[i];
+    return s;
+  }
+}
+
+// The transform loops are the same for every instruction set;
+//   each copy is compiled for its own target so the optimizer
+//   (-O3, or -O2 -ftree-vectorize) can vectorize "op" with it.
+template<typename T, typename UnaryOp>
+void
+transform_scalar (T* p, size_t n, UnaryOp op)
+{
+  for (size_t i = 0; i < n; ++i)
+    p[i] = op (p[i]);
+}
+
+#if SIMD_ISA_X86
+
+/************************************************************/
+// AVX2 kernels, 8 lanes
+
+#define ARRAY_SIMD_AVX2 __attribute__ ((target ("avx2")))
+
+ARRAY_SIMD_AVX2 inline size_t
+find_avx2 (const int* p, size_t n, int value)
+{
+  const __m256i key = _mm256_set1_epi32 (value);
+  size_t i = 0;
+  for (; i + 8 <= n; i += 8)
+  {
+    __m256i x = _mm256_loadu_si256 (reinterpret_cast<const __m256i*> (p + i));
+    int mask = _mm256_movemask_ps (
+      _mm256_castsi256_ps (_mm256_cmpeq_epi32 (x, key)));
+    if (mask != 0)
+      return i + __builtin_ctz (mask);
+  }
+  return i + find_scalar (p + i, n - i, value);
+}
+
+ARRAY_SIMD_AVX2 inline size_t
+find_avx2 (const float* p, size_t n, float value)
+{
+  const __m256 key = _mm256_set1_ps (value);
+  size_t i = 0;
+  for (; i + 8 <= n; i += 8)
+  {
+    int mask = _mm256_movemask_ps (
+      _mm256_cmp_ps (_mm256_loadu_ps (p + i), key, _CMP_EQ_OQ));
+    if (mask != 0)
+      return i + __builtin_ctz (mask);
+  }
+  return i + find_scalar (p + i, n - i, value);
+}
+
+// A match is all ones (-1) in its lane, so subtracting the compare
+//   result counts matches per lane.
+ARRAY_SIMD_AVX2 inline size_t
+count_avx2 (const int* p, size_t n, int value)
+{
+  const __m256i key = _mm256_set1_epi32 (value);
+  __m256i counts = _mm256_setzero_si256 ();
+  size_t i = 0;
+  for (; i + 8 <= n; i += 8)
+  {
+    __m256i x = _mm256_loadu_si256 (reinterpret_cast<const __m256i*> (p + i));
+    counts = _mm256_sub_epi32 (counts, _mm256_cmpeq_epi32 (x, key));
+  }
+  alignas (32) unsigned lanes[8];
+  _mm256_store_si256 (reinterpret_cast<__m256i*> (lanes), counts);
+  size_t count = 0;
+  for (unsigned c : lanes)
+    count += c;
+  return count + count_scalar (p + i, n - i, value);
+}
+
+ARRAY_SIMD_AVX2 inline size_t
+count_avx2 (const float* p, size_t n, float value)
+{
+  const __m256 key = _mm256_set1_ps (value);
+  size_t count = 0;
+  size_t i = 0;
+  for (; i + 8 <= n; i += 8)
+    count += __builtin_popcount (_mm256_movemask_ps (
+      _mm256_cmp_ps (_mm256_loadu_ps (p + i), key, _CMP_EQ_OQ)));
+  return count + count_scalar (p + i, n - i, value);
+}
+
+ARRAY_SIMD_AVX2 inline int
+min_avx2 (const int* p, size_t n)
+{
+  if (n < 8)
+    return min_scalar (p, n);
+  __m256i m = _mm256_loadu_si256 (reinterpret_cast<const __m256i*> (p));
+  size_t i = 8;
+  for (; i + 8 <= n; i += 8)
+    m = _mm256_min_epi32 (
+      m, _mm256_loadu_si256 (reinterpret_cast<const __m256i*> (p + i)));
+  alignas (32) int lanes[8];
+  _mm256_store_si256 (reinterpret_cast<__m256i*> (lanes), m);
+  int result = min_scalar (lanes, 8);
+  return i < n ? std::min (result, min_scalar (p + i, n - i)) : result;
+}
+
+ARRAY_SIMD_AVX2 inline float
+min_avx2 (const float* p, size_t n)
+{
+  if (n < 8)
+    return min_scalar (p, n);
+  __m256 m = _mm256_loadu_ps (p);
+  size_t i = 8;
+  for (; i + 8 <= n; i += 8)
+    m = _mm256_min_ps (m, _mm256_loadu_ps (p + i));
+  alignas (32) float lanes[8];
+  _mm256_store_ps (lanes, m);
+  float result = min_scalar (lanes, 8);
+  return i < n ? std::min (result, min_scalar (p + i, n - i)) : result;
+}
+
+ARRAY_SIMD_AVX2 inline int
+max_avx2 (const int* p, size_t n)
+{
+  if (n < 8)
+    return max_scalar (p, n);
+  __m256i m = _mm256_loadu_si256 (reinterpret_cast<const __m256i*> (p));
+  size_t i = 8;
+  for (; i + 8 <= n; i += 8)
+    m = _mm256_max_epi32 (
+      m, _mm256_loadu_si256 (reinterpret_cast<const __m256i*> (p + i)));
+  alignas (32) int lanes[8];
+  _mm256_store_si256 (reinterpret_cast<__m256i*> (lanes), m);
+  int result = max_scalar (lanes, 8);
+  return i < n ? std::max (result, max_scalar (p + i, n - i)) : result;
+}
+
+ARRAY_SIMD_AVX2 inline float
+max_avx2 (const float* p, size_t n)
+{
+  if (n < 8)
+    return max_scalar (p, n);
+  __m256 m = _mm256_loadu_ps (p);
+  size_t i = 8;
+  for (; i + 8 <= n; i += 8)
+    m = _mm256_max_ps (m, _mm256_loadu_ps (p + i));
+  alignas (32) float lanes[8];
+  _mm256_store_ps (lanes, m);
+  float result = max_scalar (lanes, 8);
+  return i < n ? std::max (result, max_scalar (p + i, n - i)) : result;
+}
+
+// Integer sums wrap around, as unsigned arithmetic would.
+ARRAY_SIMD_AVX2 inline int
+sum_avx2 (const int* p, size_t n)
+{
+  __m256i s = _mm256_setzero_si256 ();
+  size_t i = 0;
+  for (; i + 8 <= n; i += 8)
+    s = _mm256_add_epi32 (
+      s, _mm256_loadu_si256 (reinterpret_cast<const __m256i*> (p + i)));
+  alignas (32) unsigned lanes[8];
+  _mm256_store_si256 (reinterpret_cast<__m256i*> (lanes), s);
+  unsigned result = 0;
+  for (unsigned l : lanes)
+    result += l;
+  for (; i < n; ++i)
+    result += static_cast<unsigned> (p[i]);
+  return static_cast<int> (result);
+}
+
+// Float sums use two sets of 8 partial sums, so the result can
+//   differ from the scalar loop in the last bits.
+ARRAY_SIMD_AVX2 inline float
+sum_avx2 (const float* p, size_t n)
+{
+  __m256 s0 = _mm256_setzero_ps ();
+  __m256 s1 = _mm256_setzero_ps ();
+  size_t i = 0;
+  for (; i + 16 <= n; i += 16)
+  {
+    s0 = _mm256_add_ps (s0, _mm256_loadu_ps (p + i));
+    s1 = _mm256_add_ps (s1, _mm256_loadu_ps (p + i + 8));
+  }
+  alignas (32) float lanes[8];
+  _mm256_store_ps (lanes, _mm256_add_ps (s0, s1));
+  return sum_scalar (lanes, 8) + sum_scalar (p + i, n - i);
+}
+
+template<typename T, typename UnaryOp>
+ARRAY_SIMD_AVX2 void
+transform_avx2 (T* p, size_t n, UnaryOp op)
+{
+  for (size_t i = 0; i < n; ++i)
+    p[i] = op (p[i]);
+}
+
+#undef ARRAY_SIMD_AVX2
+
+/************************************************************/
+// AVX-512 kernels, 16 lanes; tails use masked loads
+
+SIMD_ISA_AVX512_BEGIN
+
+#define ARRAY_SIMD_AVX512 __attribute__ ((target ("avx512f")))
+
+// Mask with the low "n" (< 16) bits set.
+ARRAY_SIMD_AVX512 inline __mmask16
+tail_mask (size_t n)
+{
+  return static_cast<__mmask16> ((1u << n) - 1);
+}
+
+ARRAY_SIMD_AVX512 inline size_t
+find_avx512 (const int* p, size_t n, int value)
+{
+  const __m512i key = _mm512_set1_epi32 (value);
+  size_t i = 0;
+  for (; i + 16 <= n; i += 16)
+  {
+    __mmask16 mask = _mm512_cmpeq_epi32_mask (_mm512_loadu_si512 (p + i), key);
+    if (mask != 0)
+      return i + __builtin_ctz (mask);
+  }
+  __mmask16 tail = tail_mask (n - i);
+  __mmask16 mask =
+    _mm512_mask_cmpeq_epi32_mask (tail, _mm512_maskz_loadu_epi32 (tail, p + i),
+                                  key);
+  return mask != 0 ? i + __builtin_ctz (mask) : n;
+}
+
+ARRAY_SIMD_AVX512 inline size_t
+find_avx512 (const float* p, size_t n, float value)
+{
+  const __m512 key = _mm512_set1_ps (value);
+  size_t i = 0;
+  for (; i + 16 <= n; i += 16)
+  {
+    __mmask16 mask =
+      _mm512_cmp_ps_mask (_mm512_loadu_ps (p + i), key, _CMP_EQ_OQ);
+    if (mask != 0)
+      return i + __builtin_ctz (mask);
+  }
+  __mmask16 tail = tail_mask (n - i);
+  __mmask16 mask = _mm512_mask_cmp_ps_mask (
+    tail, _mm512_maskz_loadu_ps (tail, p + i), key, _CMP_EQ_OQ);
+  return mask != 0 ? i + __builtin_ctz (mask) : n;
+}
+
+ARRAY_SIMD_AVX512 inline size_t
+count_avx512 (const int* p, size_t n, int value)
+{
+  const __m512i key = _mm512_set1_epi32 (value);
+  size_t count = 0;
+  size_t i = 0;
+  for (; i + 16 <= n; i += 16)
+    count += __builtin_popcount (
+      _mm512_cmpeq_epi32_mask (_mm512_loadu_si512 (p + i), key));
+  __mmask16 tail = tail_mask (n - i);
+  return count + __builtin_popcount (_mm512_mask_cmpeq_epi32_mask (
+                   tail, _mm512_maskz_loadu_epi32 (tail, p + i), key));
+}
+
+ARRAY_SIMD_AVX512 inline size_t
+count_avx512 (const float* p, size_t n, float value)
+{
+  const __m512 key = _mm512_set1_ps (value);
+  size_t count = 0;
+  size_t i = 0;
+  for (; i + 16 <= n; i += 16)
+    count += __builtin_popcount (
+      _mm512_cmp_ps_mask (_mm512_loadu_ps (p + i), key, _CMP_EQ_OQ));
+  __mmask16 tail = tail_mask (n - i);
+  return count + __builtin_popcount (_mm512_mask_cmp_ps_mask (
+                   tail, _mm512_maskz_loadu_ps (tail, p + i), key, _CMP_EQ_OQ));
+}
+
+// The masked-off tail lanes keep the running min (or max), so the
+//   tail needs no scalar loop.
+ARRAY_SIMD_AVX512 inline int
+min_avx512 (const int* p, size_t n)
+{
+  __m512i m = _mm512_set1_epi32 (p[0]);
+  size_t i = 0;
+  for (; i + 16 <= n; i += 16)
+    m = _mm512_min_epi32 (m, _mm512_loadu_si512 (p + i));
+  m = _mm512_mask_min_epi32 (m, tail_mask (n - i), m,
+                             _mm512_maskz_loadu_epi32 (tail_mask (n - i), p + i));
+  return _mm512_reduce_min_epi32 (m);
+}
+
+ARRAY_SIMD_AVX512 inline float
+min_avx512 (const float* p, size_t n)
+{
+  __m512 m = _mm512_set1_ps (p[0]);
+  size_t i = 0;
+  for (; i + 16 <= n; i += 16)
+    m = _mm512_min_ps (m, _mm512_loadu_ps (p + i));
+  m = _mm512_mask_min_ps (m, tail_mask (n - i), m,
+                          _mm512_maskz_loadu_ps (tail_mask (n - i), p + i));
+  return _mm512_reduce_min_ps (m);
+}
+
+ARRAY_SIMD_AVX512 inline int
+max_avx512 (const int* p, size_t n)
+{
+  __m512i m = _mm512_set1_epi32 (p[0]);
+  size_t i = 0;
+  for (; i + 16 <= n; i += 16)
+    m = _mm512_max_epi32 (m, _mm512_loadu_si512 (p + i));
+  m = _mm512_mask_max_epi32 (m, tail_mask (n - i), m,
+                             _mm512_maskz_loadu_epi32 (tail_mask (n - i), p + i));
+  return _mm512_reduce_max_epi32 (m);
+}
+
+ARRAY_SIMD_AVX512 inline float
+max_avx512 (const float* p, size_t n)
+{
+  __m512 m = _mm512_set1_ps (p[0]);
+  size_t i = 0;
+  for (; i + 16 <= n; i += 16)
+    m = _mm512_max_ps (m, _mm512_loadu_ps (p + i));
+  m = _mm512_mask_max_ps (m, tail_mask (n - i), m,
+                          _mm512_maskz_loadu_ps (tail_mask (n - i), p + i));
+  return _mm512_reduce_max_ps (m);
+}
+
+// Masked-off tail lanes load as zero, which adds nothing.
+ARRAY_SIMD_AVX512 inline int
+sum_avx512 (const int* p, size_t n)
+{
+  __m512i s = _mm512_setzero_si512 ();
+  size_t i = 0;
+  for (; i + 16 <= n; i += 16)
+    s = _mm512_add_epi32 (s, _mm512_loadu_si512 (p + i));
+  s = _mm512_add_epi32 (s, _mm512_maskz_loadu_epi32 (tail_mask (n - i), p + i));
+  // reduce unsigned: _mm512_reduce_add_epi32 adds the lanes as signed
+  //   ints, which is undefined on overflow
+  alignas (64) unsigned lanes[16];
+  _mm512_store_si512 (lanes, s);
+  unsigned result = 0;
+  for (unsigned l : lanes)
+    result += l;
+  return static_cast<int> (result);
+}
+
+ARRAY_SIMD_AVX512 inline float
+sum_avx512 (const float* p, size_t n)
+{
+  __m512 s0 = _mm512_setzero_ps ();
+  __m512 s1 = _mm512_setzero_ps ();
+  size_t i = 0;
+  for (; i + 32 <= n; i += 32)
+  {
+    s0 = _mm512_add_ps (s0, _mm512_loadu_ps (p + i));
+    s1 = _mm512_add_ps (s1, _mm512_loadu_ps (p + i + 16));
+  }
+  for (; i + 16 <= n; i += 16)
+    s0 = _mm512_add_ps (s0, _mm512_loadu_ps (p + i));
+  s1 = _mm512_add_ps (s1, _mm512_maskz_loadu_ps (tail_mask (n - i), p + i));
+  return _mm512_reduce_add_ps (_mm512_add_ps (s0, s1));
+}
+
+template<typename T, typename UnaryOp>
+ARRAY_SIMD_AVX512 void
+transform_avx512 (T* p, size_t n, UnaryOp op)
+{
+  for (size_t i = 0; i < n; ++i)
+    p[i] = op (p[i]);
+}
+
+#undef ARRAY_SIMD_AVX512
+
+SIMD_ISA_AVX512_END
+
+#endif
+
+/************************************************************/
+// Dispatch: pick the kernel for T and the active instruction set
+
+#if SIMD_ISA_X86
+#define ARRAY_SIMD_DISPATCH(name, ...)                                        \
+  if constexpr (has_kernels<T>)                                               \
+  {                                                                           \
+    switch (active_isa ())                                                    \
+    {                                                                         \
+    case Isa::Avx512:                                                         \
+      return name##_avx512 (__VA_ARGS__);                                     \
+    case Isa::Avx2:                                                           \
+      return name##_avx2 (__VA_ARGS__);                                       \
+    case Isa::Scalar:                                                         \
+      break;                                                                  \
+    }                                                                         \
+  }                                                                           \
+  return name##_scalar (__VA_ARGS__)
+#else
+#define ARRAY_SIMD_DISPATCH(name, ...) return name##_scalar (__VA_ARGS__)
+#endif
+
+// Return the index of the first element equal to "value", or n.
+template<typename T>
+size_t
+find (const T* p, size_t n, const T& value)
+{
+  ARRAY_SIMD_DISPATCH (find, p, n, value);
+}
+
+// Return how many elements equal "value".
+template<typename T>
+size_t
+count (const T* p, size_t n, const T& value)
+{
+  ARRAY_SIMD_DISPATCH (count, p, n, value);
+}
+
+// Return the smallest element. Needs n > 0.
+// NOTE: with NaNs in a float range the result is unspecified.
+template<typename T>
+T
+min (const T* p, size_t n)
+{
+  ARRAY_SIMD_DISPATCH (min, p, n);
+}
+
+// Return the largest element. Needs n > 0.
+template<typename T>
+T
+max (const T* p, size_t n)
+{
+  ARRAY_SIMD_DISPATCH (max, p, n);
+}
+
+// Return the sum of the elements, starting from T ().
+template<typename T>
+T
+sum (const T* p, size_t n)
+{
+  ARRAY_SIMD_DISPATCH (sum, p, n);
+}
+
+// Replace each element "x" with "op (x)".
+template<typename T, typename UnaryOp>
+void
+transform (T* p, size_t n, UnaryOp op)
+{
+#if SIMD_ISA_X86
+  switch (active_isa ())
+  {
+  case Isa::Avx512:
+    return transform_avx512 (p, n, op);
+  case Isa::Avx2:
+    return transform_avx2 (p, n, op);
+  case Isa::Scalar:
+    break;
+  }
+#endif
+  transform_scalar (p, n, op);
+}
+
+#undef ARRAY_SIMD_DISPATCH
+
+} // end namespace ArraySimd
+
+/************************************************************/
+
+#endif
+
+/************************************************************/
@@ -0,0 +1,421 @@
+/*
+  Filename   : Deque.hpp
+  Author     : Joshua Carney
+  Course     : CSCI 362
+  Assignment : N/A
+  Description: Deque class, a double-ended queue stored in a ring
+                 buffer. push/pop at either end is amortized O(1),
+                 where Array pays O(n) at the front.
+
+                 Capacity works exactly like Array's: reserve only
+                 grows, growth follows the same growth policy, and
+                 spare capacity is left unconstructed.
+*/
+
+/************************************************************/
+// Macro guard to prevent multiple inclusions
+
+#ifndef DEQUE_H
+#define DEQUE_H
+
+/************************************************************/
+// System includes
+
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+/************************************************************/
+// Local includes
+
+#include "Array.hpp"
+
+/************************************************************/
+
+// Global heap usage of every Deque (see MemoryUsage.hpp).
+inline MemoryAccounting::Counter&
+deque_memory ()
+{
+  static MemoryAccounting::Counter counter ("Deque");
+  return counter;
+}
+
+// Random access iterator over a Deque.
+//   "D" is the (possibly const) Deque type, "V" the (possibly
+//   const) value type.
+// A position is a logical index into the Deque, so iterators
+//   stay valid across push_back as long as no reallocation occurs.
+template<typename D, typename V>
+struct DequeIterator
+{
+  using value_type = std::remove_const_t<V>;
+  using pointer = V*;
+  using reference = V&;
+  using difference_type = ptrdiff_t;
+  using iterator_category = std::random_access_iterator_tag;
+
+  DequeIterator (D* d = nullptr, size_t index = 0)
+    : m_deque (d), m_index (index)
+  {
+  }
+
+  // Convert an iterator to a const_iterator.
+  template<typename D2, typename V2,
+           typename = std::enable_if_t<std::is_convertible_v<D2*, D*>>>
+  DequeIterator (const DequeIterator<D2, V2>& i)
+    : m_deque (i.m_deque), m_index (i.m_index)
+  {
+  }
+
+  reference operator* () const { return (*m_deque)[m_index]; }
+  pointer operator-> () const { return &**this; }
+  reference operator[] (difference_type n) const { return (*m_deque)[m_index + n]; }
+
+  DequeIterator& operator++ () { ++m_index; return *this; }
+  DequeIterator& operator-- () { --m_index; return *this; }
+  DequeIterator operator++ (int) { DequeIterator copy (*this); ++m_index; return copy; }
+  DequeIterator operator-- (int) { DequeIterator copy (*this); --m_index; return copy; }
+
+  DequeIterator& operator+= (difference_type n) { m_index += n; return *this; }
+  DequeIterator& operator-= (difference_type n) { m_index -= n; return *this; }
+
+  friend DequeIterator operator+ (DequeIterator i, difference_type n) { return i += n; }
+  friend DequeIterator operator+ (difference_type n, DequeIterator i) { return i += n; }
+  friend DequeIterator operator- (DequeIterator i, difference_type n) { return i -= n; }
+
+  friend difference_type
+  operator- (const DequeIterator& i, const DequeIterator& j)
+  {
+    return static_cast<difference_type> (i.m_index - j.m_index);
+  }
+
+  friend bool operator== (const DequeIterator& i, const DequeIterator& j) { return i.m_index == j.m_index; }
+  friend bool operator!= (const DequeIterator& i, const DequeIterator& j) { return i.m_index != j.m_index; }
+  friend bool operator< (const DequeIterator& i, const DequeIterator& j) { return i.m_index < j.m_index; }
+  friend bool operator> (const DequeIterator& i, const DequeIterator& j) { return i.m_index > j.m_index; }
+  friend bool operator<= (const DequeIterator& i, const DequeIterator& j) { return i.m_index <= j.m_index; }
+  friend bool operator>= (const DequeIterator& i, const DequeIterator& j) { return i.m_index >= j.m_index; }
+
+  D* m_deque;
+  size_t m_index;
+};
+
+/************************************************************/
+
+// "Growth" and "Alloc" are the same policies Array uses.
+template<typename T, typename Growth = DoublingGrowth,
+         typename Alloc = HeapAllocator>
+class Deque
+{
+public:
+  using value_type = T;
+  using iterator = DequeIterator<Deque, T>;
+  using const_iterator = DequeIterator<const Deque, const T>;
+
+  using reference = value_type&;
+  using const_reference = const value_type&;
+
+  using size_type = size_t;
+  using difference_type = ptrdiff_t;
+
+  // Default ctor.
+  // Initialize an empty Deque.
+  Deque ()
+    : m_head (0),
+      m_size (0),
+      m_capacity (0),
+      m_array (nullptr)
+  {
+  }
+
+  // Size ctor.
+  // Initialize a Deque of size "pSize", with each element
+  //   set to "value".
+  explicit Deque (size_t pSize, const T& value = T ())
+    : Deque ()
+  {
+    reserve (pSize);
+    std::uninitialized_fill_n (m_array, pSize, value);
+    m_size = pSize;
+  }
+
+  // Copy ctor.
+  // The copy is unwrapped: its elements start at slot 0.
+  Deque (const Deque& d)
+    : Deque ()
+  {
+    reserve (d.capacity ());
+    std::uninitialized_copy (d.begin (), d.end (), m_array);
+    m_size = d.size ();
+  }
+
+  // Move ctor.
+  Deque (Deque&& d) noexcept
+    : Deque ()
+  {
+    swap (d);
+  }
+
+  // Destructor.
+  ~Deque () {
+    clear ();
+    deallocate (m_array, m_capacity);
+  }
+
+  // Assignment operator (copy-and-swap).
+  Deque& operator= (Deque d) noexcept {
+    swap (d);
+    return *this;
+  }
+
+  void swap (Deque& d) noexcept {
+    std::swap (m_head, d.m_head);
+    std::swap (m_size, d.m_size);
+    std::swap (m_capacity, d.m_capacity);
+    std::swap (m_array, d.m_array);
+  }
+
+  // Return the size.
+  size_t size () const {
+    return m_size;
+  }
+
+  // Return true if this Deque is empty, false o/w.
+  bool empty () const {
+    return size () == 0;
+  }
+
+  // Return the capacity.
+  size_t capacity () const {
+    return m_capacity;
+  }
+
+  // Return the element at position "index", counted from the front.
+  T& operator[] (size_t index) {
+    return m_array[slot (index)];
+  }
+
+  const T& operator[] (size_t index) const {
+    return m_array[slot (index)];
+  }
+
+  reference front () {
+    return m_array[m_head];
+  }
+
+  const_reference front () const {
+    return m_array[m_head];
+  }
+
+  reference back () {
+    return (*this)[m_size - 1];
+  }
+
+  const_reference back () const {
+    return (*this)[m_size - 1];
+  }
+
+  // Insert an element at the back.
+  void push_back (const T& item) {
+    emplace_back (item);
+  }
+
+  void push_back (T&& item) {
+    emplace_back (std::move (item));
+  }
+
+  template<typename... Args>
+  reference emplace_back (Args&&... args) {
+    if (size () == capacity ()) {
+      realloc_insert (false, std::forward<Args> (args)...);
+    }
+    else {
+      ::new (static_cast<void*> (m_array + slot (m_size)))
+        T (std::forward<Args> (args)...);
+      ++m_size;
+    }
+    return back ();
+  }
+
+  // Insert an element at the front.
+  void push_front (const T& item) {
+    emplace_front (item);
+  }
+
+  void push_front (T&& item) {
+    emplace_front (std::move (item));
+  }
+
+  template<typename... Args>
+  reference emplace_front (Args&&... args) {
+    if (size () == capacity ()) {
+      realloc_insert (true, std::forward<Args> (args)...);
+    }
+    else {
+      size_t head = m_head == 0 ? m_capacity - 1 : m_head - 1;
+      ::new (static_cast<void*> (m_array + head))
+        T (std::forward<Args> (args)...);
+      m_head = head;
+      ++m_size;
+    }
+    return front ();
+  }
+
+  // Erase the element at the back.
+  void pop_back () {
+    if (size () != 0) {
+      std::destroy_at (&back ());
+      --m_size;
+    }
+  }
+
+  // Erase the element at the front.
+  void pop_front () {
+    if (size () != 0) {
+      std::destroy_at (&front ());
+      m_head = slot (1);
+      --m_size;
+    }
+  }
+
+  // Erase every element. The capacity is unchanged.
+  void clear () {
+    while (!empty ())
+      pop_back ();
+    m_head = 0;
+  }
+
+  // Reserve capacity for "space" elements.
+  // "space" must be greater than capacity.
+  //   If not, leave the capacity unchanged.
+  // "size" must remain unchanged.
+  void reserve (size_t space) {
+    if (space > capacity ())
+      adopt (allocate (space), space, 0);
+  }
+
+  // Reduce the capacity to the size, releasing the spare memory.
+  void shrink_to_fit () {
+    if (size () < capacity ())
+      adopt (allocate (size ()), size (), 0);
+  }
+
+  // Return the heap this Deque holds.
+  MemoryUsage memory_usage () const {
+    if (m_array == nullptr)
+      return {};
+    return { m_capacity * sizeof (T), 1 };
+  }
+
+  // Return iterator pointing to the first element.
+  iterator begin () {
+    return iterator (this, 0);
+  }
+
+  const_iterator begin () const {
+    return const_iterator (this, 0);
+  }
+
+  // Return iterator pointing one beyond the last element.
+  iterator end () {
+    return iterator (this, m_size);
+  }
+
+  const_iterator end () const {
+    return const_iterator (this, m_size);
+  }
+
+private:
+  // Return the slot of the element at logical "index".
+  size_t slot (size_t index) const {
+    size_t s = m_head + index;
+    return s >= m_capacity ? s - m_capacity : s;
+  }
+
+  T* allocate (size_t space) {
+    if (space == 0)
+      return nullptr;
+    T* array = static_cast<T*> (Alloc::allocate (space * sizeof (T),
+                                                 alignof (T)));
+    MemoryAccounting::allocated<deque_memory> (space * sizeof (T));
+    return array;
+  }
+
+  void deallocate (T* array, size_t space) {
+    if (array != nullptr) {
+      MemoryAccounting::released<deque_memory> (space * sizeof (T));
+      Alloc::deallocate (array, space * sizeof (T), alignof (T));
+    }
+  }
+
+  // Relocate the elements, unwrapped, into "array" (storage for
+  //   "space" elements) starting at slot "offset", then release
+  //   the old storage and keep "array".
+  void adopt (T* array, size_t space, size_t offset) {
+    if (m_size != 0) {
+      // The live elements are at most two contiguous runs.
+      size_t first = std::min (m_size, m_capacity - m_head);
+      array_relocate (m_array + m_head, first, array + offset);
+      array_relocate (m_array, m_size - first, array + offset + first);
+    }
+    deallocate (m_array, m_capacity);
+    m_array = array;
+    m_capacity = space;
+    m_head = 0;
+  }
+
+  // Grow by the growth policy, constructing a new element from
+  //   "args" at the front (or back) of the new storage before the
+  //   old elements move, since "args" may refer to one of them.
+  template<typename... Args>
+  void realloc_insert (bool atFront, Args&&... args) {
+    size_t space = Growth::next_capacity (capacity (), size () + 1, sizeof (T));
+    T* array = allocate (space);
+    try {
+      ::new (static_cast<void*> (array + (atFront ? 0 : m_size)))
+        T (std::forward<Args> (args)...);
+    }
+    catch (...) {
+      deallocate (array, space);
+      throw;
+    }
+    adopt (array, space, atFront ? 1 : 0);
+    ++m_size;
+  }
+
+  // Stores the slot of the front element.
+  size_t m_head;
+  // Stores the number of elements in the Deque.
+  size_t m_size;
+  // Stores the capacity of the Deque, which must be at least "m_size".
+  size_t m_capacity;
+  // Stores a pointer to the ring buffer.
+  T* m_array;
+};
+
+/************************************************************************/
+// Free functions associated with the class
+
+// Output operator.
+// Allows us to do "cout << d;", where "d" is a Deque.
+template<typename T, typename Growth, typename Alloc>
+ostream&
+operator<< (ostream& output, const Deque<T, Growth, Alloc>& d)
+{
+  output << "[ ";
+  for (const auto& elem : d)
+    output << elem << " ";
+
+  output << "]";
+
+  return output;
+}
+
+#endif
+
+/************************************************************************/
@@ -0,0 +1,131 @@
+/*
+  Filename   : DequeDriver.cc
+  Author     : Joshua Carney
+  Course     : CSCI 362
+  Assignment : N/A
+  Description: Test the Deque class.
+*/   
+
+/************************************************************/
+// System includes
+
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <iterator>
+#include <sstream>
+#include <cassert>
+
+/************************************************************/
+// Local includes
+
+#include "Deque.hpp"
+
+/************************************************************/
+// Using declarations
+
+using std::cout;
+using std::endl;
+using std::string;
+using std::ostringstream;
+
+/************************************************************/
+// Function prototypes/global vars/typedefs
+
+void
+printTestResult (const string& test,
+		 const string& expected,
+		 const ostringstream& actual);
+
+/************************************************************/
+
+int      
+main (int argc, char* argv[]) 
+{        
+  Deque<int> A;
+
+  ostringstream output;
+  output << A << " " << A.empty ();
+  printTestResult ("no-arg ctor", "[ ] 1", output);
+
+  for (int i = 0; i < 3; ++i)
+  {
+    A.push_back (i);
+    A.push_front (-i - 1);
+  }
+
+  output.str ("");
+  output << A << " " << A.size () << " " << A.front () << " " << A.back ();
+  printTestResult ("push both ends", "[ -3 -2 -1 0 1 2 ] 6 -3 2", output);
+
+  // A sliding window: the ring wraps without ever growing
+  Deque<int> W;
+  W.reserve (4);
+  for (int i = 0; i < 100; ++i)
+  {
+    if (W.size () == 4)
+      W.pop_front ();
+    W.push_back (i);
+  }
+
+  output.str ("");
+  output << W << " " << W.capacity () << " " << W[0] << " "
+         << (W.end () - W.begin ());
+  printTestResult ("sliding window", "[ 96 97 98 99 ] 4 96 4", output);
+
+  // Growing while wrapped keeps the order
+  W.push_front (95);
+  W.push_back (W.front ());
+
+  output.str ("");
+  output << W << " " << W.capacity ();
+  printTestResult ("grow while wrapped", "[ 95 96 97 98 99 95 ] 8", output);
+
+  // Iterators are random access
+  Deque<int> C (W);
+  C.pop_back ();
+  std::reverse (C.begin (), C.end ());
+  C.shrink_to_fit ();
+
+  const Deque<int>& CR = C;
+  Deque<int>::const_iterator ci = C.begin ();
+
+  output.str ("");
+  output << C << " " << C.capacity () << " " << *(CR.begin () + 2) << " "
+         << (ci < CR.end ());
+  printTestResult ("copy and iterators", "[ 99 98 97 96 95 ] 5 97 1", output);
+
+  Deque<string> S;
+  S.push_front ("b");
+  S.push_front ("a");
+  S.push_back ("c");
+  Deque<string> T (std::move (S));
+  S = T;
+  T.pop_front ();
+  T.pop_back ();
+
+  output.str ("");
+  output << S << " " << T;
+  printTestResult ("strings", "[ a b c ] [ b ]", output);
+
+  return EXIT_SUCCESS;
+}
+
+/************************************************************/
+
+void
+printTestResult (const string& test,
+		 const string& expected,
+		 const ostringstream& actual)
+{
+  cout << "Test: " << test << endl;
+  cout << "==========================" << endl;
+  cout << "Expected: " << expected << endl;
+  cout << "Actual  : " << actual.str () << endl;
+  cout << "==========================" << endl << endl;
+
+  // Ensure the two results are the same
+  assert (expected == actual.str ());
+}
+
+/************************************************************/
@@ -26,6 +26,8 @@
 /************************************************************/
 // Local includes
 
+#include "../../common/MemoryUsage.hpp"
+
 /************************************************************/
 // Using declarations
 
@@ -34,6 +36,16 @@ using std::queue;
 
 /************************************************************/
 
+// Global heap usage of every SearchTree (see MemoryUsage.hpp).
+inline MemoryAccounting::Counter&
+tree_memory ()
+{
+  static MemoryAccounting::Counter counter ("SearchTree");
+  return counter;
+}
+
+/************************************************************/
+
 template<typename T>
 struct Node
 {
@@ -252,6 +264,13 @@ public:
     return m_size;
   }
 
+  // Return the heap held by this tree: one node per element.
+  MemoryUsage
+  memory_usage () const
+  {
+    return { m_size * sizeof (Node), m_size };
+  }
+
   int
   depth () const
   {
@@ -426,6 +445,7 @@ private:
     //Case empty tree:
     if(r == nullptr){
       r = new Node(v, nullptr, nullptr, parent);
+      MemoryAccounting::allocated<tree_memory> (sizeof (Node));
       ++m_size;
       return r;
     }
@@ -476,6 +496,7 @@ private:
         child->parent = r->parent;
       }
         
+      MemoryAccounting::released<tree_memory> (sizeof (Node));
       delete r;
       r = child;
       --m_size;
@@ -524,11 +545,10 @@ private:
   {
     // Delete all nodes in the tree rooted at "r".
     if(r) {
-      if(r->left != nullptr)
-        clear(r->left);
-      else if(r->right != nullptr)
-        clear(r->right);
-      
+      clear(r->left);
+      clear(r->right);
+
+      MemoryAccounting::released<tree_memory> (sizeof (Node));
       delete r;
     }
   }
@@ -0,0 +1,269 @@
+/*
+  Filename   : MemoryUsage.hpp
+  Author     : Joshua Carney
+  Course     : CSCI 362
+  Assignment : N/A
+  Description: Heap accounting shared by the containers.
+
+                 Every container answers memory_usage (): the heap
+                 bytes and blocks it holds right now. Each works it
+                 out from its own bookkeeping (size, capacity), so
+                 the answer costs nothing to keep.
+
+                 Built with -DMEMORY_ACCOUNTING, each kind of
+                 container also reports every allocation and release
+                 to a global Counter, and MemoryAccounting::report
+                 prints live and peak usage per kind. Without the
+                 flag the hooks compile to nothing.
+*/
+
+/************************************************************/
+// Macro guard to prevent multiple inclusions
+
+#ifndef MEMORY_USAGE_H
+#define MEMORY_USAGE_H
+
+/************************************************************/
+// System includes
+
+#include <atomic>
+#include <cstddef>
+#include <iostream>
+#include <memory>
+#include <mutex>
+
+/************************************************************/
+
+// Heap held by one container, or by many.
+struct MemoryUsage
+{
+  // Bytes requested from the allocator.
+  size_t bytes = 0;
+  // Blocks those bytes are split across.
+  size_t allocations = 0;
+
+  MemoryUsage&
+  operator+= (const MemoryUsage& u)
+  {
+    bytes += u.bytes;
+    allocations += u.allocations;
+    return *this;
+  }
+};
+
+inline MemoryUsage
+operator+ (MemoryUsage a, const MemoryUsage& b)
+{
+  return a += b;
+}
+
+inline std::ostream&
+operator<< (std::ostream& output, const MemoryUsage& u)
+{
+  return output << u.bytes << " bytes in " << u.allocations << " blocks";
+}
+
+/************************************************************/
+
+namespace MemoryAccounting
+{
+
+#if defined(MEMORY_ACCOUNTING)
+constexpr bool enabled = true;
+#else
+constexpr bool enabled = false;
+#endif
+
+class Counter;
+
+// The counters, linked in the order they were first used.
+inline std::mutex&
+registry_mutex ()
+{
+  static std::mutex mutex;
+  return mutex;
+}
+
+inline Counter*&
+registry_head ()
+{
+  static Counter* head = nullptr;
+  return head;
+}
+
+// Global heap usage of one kind of container, e.g. every List<T>
+//   for every T. Safe to update from several threads.
+class Counter
+{
+public:
+  explicit Counter (const char* name)
+    : m_name (name)
+  {
+    std::lock_guard<std::mutex> lock (registry_mutex ());
+    m_next = registry_head ();
+    registry_head () = this;
+  }
+
+  Counter (const Counter&) = delete;
+  Counter& operator= (const Counter&) = delete;
+
+  void
+  allocated (size_t bytes)
+  {
+    size_t live = m_bytes.fetch_add (bytes, std::memory_order_relaxed) + bytes;
+    m_allocations.fetch_add (1, std::memory_order_relaxed);
+    m_totalAllocations.fetch_add (1, std::memory_order_relaxed);
+    size_t peak = m_peakBytes.load (std::memory_order_relaxed);
+    while (live > peak
+           && !m_peakBytes.compare_exchange_weak (peak, live,
+                                                  std::memory_order_relaxed))
+    {
+    }
+  }
+
+  void
+  released (size_t bytes)
+  {
+    m_bytes.fetch_sub (bytes, std::memory_order_relaxed);
+    m_allocations.fetch_sub (1, std::memory_order_relaxed);
+  }
+
+  const char*
+  name () const
+  {
+    return m_name;
+  }
+
+  // Live usage.
+  MemoryUsage
+  usage () const
+  {
+    return { m_bytes.load (std::memory_order_relaxed),
+             m_allocations.load (std::memory_order_relaxed) };
+  }
+
+  // The most bytes ever live at once.
+  size_t
+  peak_bytes () const
+  {
+    return m_peakBytes.load (std::memory_order_relaxed);
+  }
+
+  // Every allocation so far, including those since released.
+  size_t
+  total_allocations () const
+  {
+    return m_totalAllocations.load (std::memory_order_relaxed);
+  }
+
+  const Counter*
+  next () const
+  {
+    return m_next;
+  }
+
+private:
+  const char* m_name;
+  std::atomic<size_t> m_bytes{0};
+  std::atomic<size_t> m_allocations{0};
+  std::atomic<size_t> m_peakBytes{0};
+  std::atomic<size_t> m_totalAllocations{0};
+  Counter* m_next;
+};
+
+// Hooks for the containers. "Kind" returns the container's Counter.
+template<Counter& (*Kind) ()>
+inline void
+allocated (size_t bytes)
+{
+  if constexpr (enabled)
+    Kind ().allocated (bytes);
+}
+
+template<Counter& (*Kind) ()>
+inline void
+released (size_t bytes)
+{
+  if constexpr (enabled)
+    Kind ().released (bytes);
+}
+
+// Live usage summed over every kind of container.
+inline MemoryUsage
+total ()
+{
+  std::lock_guard<std::mutex> lock (registry_mutex ());
+  MemoryUsage sum;
+  for (const Counter* c = registry_head (); c != nullptr; c = c->next ())
+    sum += c->usage ();
+  return sum;
+}
+
+// Print one line per kind of container used so far.
+inline void
+report (std::ostream& output)
+{
+  std::lock_guard<std::mutex> lock (registry_mutex ());
+  for (const Counter* c = registry_head (); c != nullptr; c = c->next ())
+    output << c->name () << ": " << c->usage () << ", peak "
+           << c->peak_bytes () << " bytes, " << c->total_allocations ()
+           << " allocations in all\n";
+}
+
+// A std::allocator that reports to "Kind", for containers built
+//   on the standard library.
+template<typename U, Counter& (*Kind) ()>
+struct CountingAllocator
+{
+  using value_type = U;
+
+  template<typename V>
+  struct rebind
+  {
+    using other = CountingAllocator<V, Kind>;
+  };
+
+  CountingAllocator () = default;
+
+  template<typename V>
+  CountingAllocator (const CountingAllocator<V, Kind>&)
+  {
+  }
+
+  U*
+  allocate (size_t n)
+  {
+    U* p = std::allocator<U> ().allocate (n);
+    MemoryAccounting::allocated<Kind> (n * sizeof (U));
+    return p;
+  }
+
+  void
+  deallocate (U* p, size_t n)
+  {
+    MemoryAccounting::released<Kind> (n * sizeof (U));
+    std::allocator<U> ().deallocate (p, n);
+  }
+
+  template<typename V>
+  bool
+  operator== (const CountingAllocator<V, Kind>&) const
+  {
+    return true;
+  }
+
+  template<typename V>
+  bool
+  operator!= (const CountingAllocator<V, Kind>&) const
+  {
+    return false;
+  }
+};
+
+}
+
+/************************************************************/
+
+#endif
+
+/************************************************************/
@@ -0,0 +1,97 @@
+/*
+  Filename   : SimdIsa.hpp
+  Author     : Joshua Carney
+  Course     : CSCI 362
+  Assignment : N/A
+  Description: Instruction set selection shared by the vector kernels.
+
+                 ArraySimd, Vect's kernels and the SIMD partition all
+                 pick between a scalar, an AVX2 and an AVX-512 kernel
+                 at run time. They share the one selection here, so
+                 set_isa restricts every module at once.
+*/
+
+/************************************************************/
+// Macro guard to prevent multiple inclusions
+
+#ifndef SIMD_ISA_H
+#define SIMD_ISA_H
+
+/************************************************************/
+// System includes
+
+#include <algorithm>
+
+#if defined(__x86_64__) && defined(__GNUC__)
+#define SIMD_ISA_X86 1
+#include <immintrin.h>
+#else
+#define SIMD_ISA_X86 0
+#endif
+
+/************************************************************/
+// AVX-512 kernels go between SIMD_ISA_AVX512_BEGIN and
+// SIMD_ISA_AVX512_END.
+//   GCC 12's own AVX-512 headers trip -Wuninitialized and
+//   -Wmaybe-uninitialized (GCC bug 105593): intrinsics such as
+//   _mm512_castsi256_si512 start from an undefined vector on purpose.
+//   The warnings are about the headers, not the kernels, so they are
+//   switched off for just those kernels.
+
+#define SIMD_ISA_AVX512_BEGIN                                                 \
+  _Pragma ("GCC diagnostic push")                                             \
+  _Pragma ("GCC diagnostic ignored \"-Wuninitialized\"")                      \
+  _Pragma ("GCC diagnostic ignored \"-Wmaybe-uninitialized\"")
+
+#define SIMD_ISA_AVX512_END _Pragma ("GCC diagnostic pop")
+
+/************************************************************/
+
+namespace SimdIsa
+{
+
+// Instruction sets, from least to most capable.
+enum class Isa
+{
+  Scalar,
+  Avx2,
+  Avx512
+};
+
+// Return the best instruction set this CPU supports.
+inline Isa
+detect_isa ()
+{
+#if SIMD_ISA_X86
+  __builtin_cpu_init ();
+  if (__builtin_cpu_supports ("avx512f"))
+    return Isa::Avx512;
+  if (__builtin_cpu_supports ("avx2"))
+    return Isa::Avx2;
+#endif
+  return Isa::Scalar;
+}
+
+// The instruction set every module's kernels dispatch to.
+inline Isa&
+active_isa ()
+{
+  static Isa isa = detect_isa ();
+  return isa;
+}
+
+// Restrict the kernels to "isa" (for testing and benchmarks).
+//   Asking for more than the CPU supports gets what it supports.
+inline void
+set_isa (Isa isa)
+{
+  active_isa () = std::min (isa, detect_isa ());
+}
+
+} // end namespace SimdIsa
+
+/************************************************************/
+
+#endif
+
+/************************************************************/
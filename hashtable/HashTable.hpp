@@ -33,15 +33,25 @@
 
 /*********************************************************/
 //local includes
+#include "../common/MemoryUsage.hpp"
 
-
+//global heap usage of every HashTable (see MemoryUsage.hpp)
+inline MemoryAccounting::Counter& hashtable_memory(){
+    static MemoryAccounting::Counter counter("HashTable");
+    return counter;
+}
 
 template<typename T>
 class HashTable{
 
+    //the buckets and their nodes report to hashtable_memory
+    template<typename U>
+    using Allocator = MemoryAccounting::CountingAllocator<U, hashtable_memory>;
+    using Bucket = std::list<std::pair<int, T>, Allocator<std::pair<int, T>>>;
+
     //data memeber: bucket array (a list vector) 
     //Each list is a <int, T> pair list
-    std::vector<std::list<std::pair<int, T>>> m_table;
+    std::vector<Bucket, Allocator<Bucket>> m_table;
 
 public:
 
@@ -49,11 +59,26 @@ public:
     HashTable() : m_table()
     {
       for(int i = 0; i < 11; ++i) {
-          std::list<std::pair<int, T>> listPair;
+          Bucket listPair;
           m_table.push_back(listPair);
       }
     }
 
+    //heap held by this table: the bucket array, plus one list node
+    //(the pair and two links) per entry
+    MemoryUsage memory_usage() const{
+        MemoryUsage usage;
+        if(m_table.capacity() != 0) {
+            usage.bytes = m_table.capacity() * sizeof(Bucket);
+            usage.allocations = 1;
+        }
+        for(const Bucket& bucket : m_table) {
+            usage.bytes += bucket.size() * (sizeof(std::pair<int, T>) + 2 * sizeof(void*));
+            usage.allocations += bucket.size();
+        }
+        return usage;
+    }
+
     //Hash Function
     //Division Hashing mod k where k is a prime number close to the input size
     int hash_function(const int& key){
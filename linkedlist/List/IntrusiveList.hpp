@@ -0,0 +1,445 @@
+/*
+  Filename   : IntrusiveList.hpp
+  Author(s)  : William Killian, Gary M. Zoppetti
+  Course     : CSCI 362-01
+  Assignment : List
+  Description: IntrusiveList class, a doubly linked list that links
+               user objects directly instead of copying them into
+               freshly allocated nodes.
+
+               A type that wants to live in an IntrusiveList derives
+               from IntrusiveListHook<Tag>, once per list it may sit
+               in. Insertion and removal never allocate, and an object
+               may be in several lists at once (one per Tag).
+*/
+
+/************************************************************/
+// Macro guard to prevent multiple inclusions
+
+#ifndef INTRUSIVE_LIST_HPP_
+#define INTRUSIVE_LIST_HPP_
+
+/************************************************************/
+// System includes
+
+// for ostream
+#include <iostream>
+// for bidirectional_iterator_tag, next, distance
+#include <iterator>
+// for is_base_of, is_same, remove_const
+#include <type_traits>
+// for ptrdiff_t, size_t, swap
+#include <utility>
+
+/************************************************************/
+// Forward declaration of types
+
+template<typename T, typename Tag>
+class IntrusiveList;
+
+/************************************************************/
+// struct representing the links embedded in a user object
+//
+// contains two data members:
+// - next
+// - prev
+//
+// "Tag" distinguishes the hooks when one object is a member of
+//   several lists at once, e.g.
+//
+//   struct Conn : IntrusiveListHook<AllTag>, IntrusiveListHook<IdleTag>
+//
+// NOTE: a hook is never copied -- copying an object leaves the copy
+//   unlinked, so a copy can never corrupt the original's list
+
+template<typename Tag = void>
+struct IntrusiveListHook
+{
+  IntrusiveListHook () = default;
+
+  IntrusiveListHook (const IntrusiveListHook&)
+  {
+  }
+
+  IntrusiveListHook&
+  operator= (const IntrusiveListHook&)
+  {
+    return *this;
+  }
+
+  // unhooks the range [begin,end] from a linked list
+  // NOTE: same contract as ListNode::unhook_range, the links inside
+  //   [begin,end] are left untouched
+  static void
+  unhook_range (IntrusiveListHook* begin, IntrusiveListHook* end)
+  {
+    begin->prev->next = end->next;
+    end->next->prev = begin->prev;
+  }
+
+  // inserts the range [first,last] before this
+  // NOTE: does not create any new nodes, does not destroy any existing nodes
+  void
+  hook_range (IntrusiveListHook* first, IntrusiveListHook* last)
+  {
+    this->prev->next = first;
+    first->prev = this->prev;
+    this->prev = last;
+    last->next = this;
+  }
+
+  // insert first before this
+  void
+  hook (IntrusiveListHook* first)
+  {
+    hook_range (first, first);
+  }
+
+  // unhooks current node from linked list and marks it unlinked
+  void
+  unhook ()
+  {
+    IntrusiveListHook::unhook_range (this, this);
+    next = nullptr;
+    prev = nullptr;
+  }
+
+  // returns true if this hook currently sits in a list
+  bool
+  is_linked () const noexcept
+  {
+    return next != nullptr;
+  }
+
+  IntrusiveListHook* next{nullptr};
+  IntrusiveListHook* prev{nullptr};
+};
+
+/************************************************************/
+// Struct representing an IntrusiveList iterator
+//
+// "T" is const-qualified for a const_iterator
+//
+// contains a single data member:
+// - m_hookPtr
+
+template<typename T, typename Tag>
+struct IntrusiveListIterator
+{
+  using value_type = std::remove_const_t<T>;
+  using pointer = T*;
+  using reference = T&;
+  using difference_type = std::ptrdiff_t;
+  using iterator_category = std::bidirectional_iterator_tag;
+
+  using Hook = IntrusiveListHook<Tag>;
+
+public:
+  // construct from Hook
+  IntrusiveListIterator (Hook* h) : m_hookPtr (h)
+  {
+  }
+
+  // construct a const_iterator from an iterator
+  template<typename U,
+           typename = std::enable_if_t<std::is_same_v<const U, T>>>
+  IntrusiveListIterator (const IntrusiveListIterator<U, Tag>& i)
+    : m_hookPtr (i.m_hookPtr)
+  {
+  }
+
+  // the hook is a base of T, so the object is just a downcast away
+  reference operator* () const
+  {
+    return static_cast<reference> (*m_hookPtr);
+  }
+
+  pointer operator-> () const
+  {
+    return &**this;
+  }
+
+  IntrusiveListIterator&
+  operator++ ()
+  {
+    m_hookPtr = m_hookPtr->next;
+    return *this;
+  }
+
+  IntrusiveListIterator
+  operator++ (int)
+  {
+    IntrusiveListIterator copy (*this);
+    m_hookPtr = m_hookPtr->next;
+    return copy;
+  }
+
+  IntrusiveListIterator&
+  operator-- ()
+  {
+    m_hookPtr = m_hookPtr->prev;
+    return *this;
+  }
+
+  IntrusiveListIterator
+  operator-- (int)
+  {
+    IntrusiveListIterator copy (*this);
+    m_hookPtr = m_hookPtr->prev;
+    return copy;
+  }
+
+  friend bool
+  operator== (const IntrusiveListIterator& i, const IntrusiveListIterator& j)
+  {
+    return i.m_hookPtr == j.m_hookPtr;
+  }
+
+  friend bool
+  operator!= (const IntrusiveListIterator& i, const IntrusiveListIterator& j)
+  {
+    return i.m_hookPtr != j.m_hookPtr;
+  }
+
+private:
+  Hook* m_hookPtr{nullptr};
+  friend class IntrusiveList<value_type, Tag>;
+  friend struct IntrusiveListIterator<const value_type, Tag>;
+};
+
+/************************************************************/
+// Class representing an IntrusiveList
+//
+// The list never owns its elements: it only links and unlinks them.
+// Every element must outlive its membership in the list.
+//
+// contains two data members:
+// - m_header
+// - m_size
+
+template<typename T, typename Tag = void>
+class IntrusiveList
+{
+  using Hook = IntrusiveListHook<Tag>;
+
+  static_assert (std::is_base_of_v<Hook, T>,
+                 "T must derive from IntrusiveListHook<Tag>");
+
+public:
+  using value_type = T;
+  using size_type = std::size_t;
+  using difference_type = std::ptrdiff_t;
+  using reference = value_type&;
+  using const_reference = const value_type&;
+  using pointer = value_type*;
+  using const_pointer = const value_type*;
+  using iterator = IntrusiveListIterator<T, Tag>;
+  using const_iterator = IntrusiveListIterator<const T, Tag>;
+
+  // default constructor
+  IntrusiveList () : m_header (), m_size (0)
+  {
+    m_header.next = &m_header;
+    m_header.prev = &m_header;
+  }
+
+  // an element can only be linked once per Tag, so lists are not copyable
+  IntrusiveList (const IntrusiveList&) = delete;
+  IntrusiveList& operator= (const IntrusiveList&) = delete;
+
+  // destructor -- unlinks, but does not destroy, every element
+  ~IntrusiveList ()
+  {
+    clear ();
+  }
+
+  iterator begin () noexcept
+  {
+    return {m_header.next};
+  }
+
+  const_iterator begin () const noexcept
+  {
+    return {m_header.next};
+  }
+
+  const_iterator cbegin () const noexcept
+  {
+    return begin ();
+  }
+
+  iterator end () noexcept
+  {
+    return {&m_header};
+  }
+
+  const_iterator end () const noexcept
+  {
+    return {const_cast<Hook*> (&m_header)};
+  }
+
+  const_iterator cend () const noexcept
+  {
+    return end ();
+  }
+
+  bool empty () const noexcept
+  {
+    return m_size == 0;
+  }
+
+  size_type size () const noexcept
+  {
+    return m_size;
+  }
+
+  // returns an iterator referring to "value", which must be in this list
+  static iterator iterator_to (reference value) noexcept
+  {
+    return {static_cast<Hook*> (&value)};
+  }
+
+  // links "value" before "pos" -- returns iterator pointing to "value"
+  // "value" must not already be linked into a list with this Tag
+  iterator insert (iterator pos, reference value)
+  {
+    Hook* h = &value;
+    pos.m_hookPtr->hook (h);
+    ++m_size;
+    return {h};
+  }
+
+  void push_back (reference value)
+  {
+    insert (end (), value);
+  }
+
+  void push_front (reference value)
+  {
+    insert (begin (), value);
+  }
+
+  reference front ()
+  {
+    return *begin ();
+  }
+
+  const_reference front () const
+  {
+    return *begin ();
+  }
+
+  reference back ()
+  {
+    return *(--end ());
+  }
+
+  const_reference back () const
+  {
+    return *(--end ());
+  }
+
+  // unlinks element pointed to by "pos" -- returns iterator to next element
+  iterator erase (iterator pos)
+  {
+    Hook* h = pos.m_hookPtr;
+    ++pos;
+    h->unhook ();
+    --m_size;
+    return pos;
+  }
+
+  // unlinks elements in the range [first, last) -- returns "last"
+  iterator erase (iterator first, iterator last)
+  {
+    while (first != last)
+    {
+      first = erase (first);
+    }
+    return last;
+  }
+
+  // unlinks "value", which must be in this list, in O(1)
+  void remove (reference value)
+  {
+    erase (iterator_to (value));
+  }
+
+  void clear ()
+  {
+    erase (begin (), end ());
+  }
+
+  void pop_back ()
+  {
+    erase (--end ());
+  }
+
+  void pop_front ()
+  {
+    erase (begin ());
+  }
+
+  void swap (IntrusiveList& other)
+  {
+    using std::swap;
+    swap (m_header.prev, other.m_header.prev);
+    swap (m_header.next, other.m_header.next);
+    // an empty header points at itself, so repoint before fixing links
+    if (m_header.next == &other.m_header)
+      m_header.next = m_header.prev = &m_header;
+    if (other.m_header.next == &m_header)
+      other.m_header.next = other.m_header.prev = &other.m_header;
+    m_header.next->prev = &m_header;
+    m_header.prev->next = &m_header;
+    other.m_header.next->prev = &other.m_header;
+    other.m_header.prev->next = &other.m_header;
+    swap (m_size, other.m_size);
+  }
+
+  // moves [first, last) from "other" to before "pos" without touching
+  //   the elements themselves
+  void
+  splice (iterator pos, IntrusiveList& other, iterator first, iterator last)
+  {
+    if (first == last)
+      return;
+    if (&other != this)
+    {
+      size_type const dist = std::distance (first, last);
+      other.m_size -= dist;
+      m_size += dist;
+    }
+    Hook* lastToBeUnhooked = last.m_hookPtr->prev;
+    Hook::unhook_range (first.m_hookPtr, lastToBeUnhooked);
+    pos.m_hookPtr->hook_range (first.m_hookPtr, lastToBeUnhooked);
+  }
+
+  void
+  splice (iterator pos, IntrusiveList& other)
+  {
+    splice (pos, other, other.begin (), other.end ());
+  }
+
+private:
+  Hook m_header;
+  size_type m_size;
+};
+
+// Output operator.
+// Allows us to do "cout << a;", where "a" is an IntrusiveList.
+template<typename T, typename Tag>
+std::ostream&
+operator<< (std::ostream& output, const IntrusiveList<T, Tag>& a)
+{
+  output << "[ ";
+  for (const auto& elem : a)
+  {
+    output << elem << " ";
+  }
+  output << "]";
+
+  return output;
+}
+
+#endif
@@ -25,6 +25,12 @@
 // for ptrdiff_t, size_t, swap
 #include <utility>
 
+/************************************************************/
+// Local includes
+
+// for MemoryUsage, MemoryAccounting
+#include "../../common/MemoryUsage.hpp"
+
 #ifndef IS_ITERATOR
 #define IS_ITERATOR(T) \
   typename = decltype (*std::declval<T&> (), void(), ++std::declval<T&> (), void())
@@ -361,6 +367,16 @@ operator!= (const ListIterator<T>& i, const ListIterator<T>& j)
   return i.m_nodePtr != j.m_nodePtr;
 }
 
+/************************************************************/
+// Global heap usage of every List (see MemoryUsage.hpp)
+
+inline MemoryAccounting::Counter&
+list_memory ()
+{
+  static MemoryAccounting::Counter counter ("List");
+  return counter;
+}
+
 /************************************************************/
 // Class representing a List
 //
@@ -503,10 +519,17 @@ public:
     return m_size;
   }
 
+  // the heap held by this list: one node per element
+  MemoryUsage memory_usage () const noexcept
+  {
+    return {m_size * sizeof (Node), m_size};
+  }
+
   // inserts "value" before "pos" -- returns iterator pointing to newly inserted element
   // [4]
   iterator insert (iterator pos, const value_type& value) {
     auto n = new Node(value);
+    MemoryAccounting::allocated<list_memory> (sizeof (Node));
     pos.m_nodePtr->hook(n);
     ++m_size;
     return --pos;
@@ -551,9 +574,11 @@ public:
   // erase element pointed to by "pos" -- returns iterator to next element
   // [4]
   iterator erase (iterator pos) {
-    Node n = *pos.m_nodePtr;
+    Node* n = pos.m_nodePtr;
     ++pos;
-    n.unhook();
+    n->unhook();
+    MemoryAccounting::released<list_memory> (sizeof (Node));
+    delete n;
     --m_size;
     return pos;
   }
@@ -20,6 +20,7 @@
 // Local includes
 
 #include "List.hpp"
+#include "IntrusiveList.hpp"
 
 /************************************************************/
 // Using declarations
@@ -34,6 +35,24 @@ using std::ostringstream;
 /************************************************************/
 // Function prototypes/global vars/typedefs
 
+// An object that sits in two intrusive lists at once
+struct IdleTag;
+
+struct Conn : IntrusiveListHook<>, IntrusiveListHook<IdleTag>
+{
+  explicit Conn (int i) : id (i)
+  {
+  }
+
+  int id;
+};
+
+std::ostream&
+operator<< (std::ostream& output, const Conn& c)
+{
+  return output << c.id;
+}
+
 void
 printTestResult (const string& test,
 		 const string& expected,
@@ -128,6 +147,40 @@ main (int argc, char* argv[])
   B.reverse();
   cout << "After Reverse:\n";
   cout << B << endl;
+  cout << endl;
+
+  // Intrusive lists link the Conn objects themselves
+  Conn pool[] = { Conn (1), Conn (2), Conn (3), Conn (4) };
+  IntrusiveList<Conn> all;
+  IntrusiveList<Conn, IdleTag> idle;
+  for (Conn& c : pool)
+    all.push_back (c);
+  idle.push_back (pool[3]);
+  idle.push_front (pool[1]);
+
+  output.str ("");
+  output << all << " " << idle;
+  printTestResult ("intrusive push", "[ 1 2 3 4 ] [ 2 4 ]", output);
+
+  all.remove (pool[1]);
+  idle.erase (idle.begin ());
+
+  output.str ("");
+  output << all << " " << idle << " " << all.size () << " "
+         << pool[1].IntrusiveListHook<>::is_linked ();
+  printTestResult ("intrusive remove", "[ 1 3 4 ] [ 4 ] 3 0", output);
+
+  IntrusiveList<Conn> spare;
+  spare.splice (spare.end (), all);
+  output.str ("");
+  output << all << " " << spare;
+  printTestResult ("intrusive splice", "[ ] [ 1 3 4 ]", output);
+
+  // One heap node per element
+  output.str ("");
+  output << B.memory_usage ().allocations << " "
+         << (B.memory_usage ().bytes == 5 * sizeof (ListNode<int>));
+  printTestResult ("memory_usage", "5 1", output);
   
   
   return EXIT_SUCCESS;
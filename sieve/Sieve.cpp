@@ -4,7 +4,11 @@
 #include <vector>
 #include "Timer.hpp"
 #include <math.h>
+#include <algorithm>
+#include <climits>
+#include <cstdint>
 #include <iostream>
+#include <thread>
 
 using std::set;
 using std::string;
@@ -101,14 +105,329 @@ sieveVector (unsigned N) {
     return allPrimes;
 };
 
+// Return the largest r with r * r <= N
+uint64_t
+isqrt (uint64_t N) {
+    uint64_t r = uint64_t(sqrtl(N));
+    while (r * r > N) {
+        --r;
+    }
+    while ((r + 1) * (r + 1) <= N) {
+        ++r;
+    }
+    return r;
+};
+
+// A segmented Sieve of Eratosthenes over the odd numbers up to N.
+//
+// Each segment holds SEGMENT_BITS odd numbers, one bit each (bit i of
+// the whole sieve is the number 2i + 1), so a segment fits in a 32 KB
+// L1 cache however large N is. Only the primes up to sqrt(N) are kept
+// between segments. Multiples of 3, 5, 7, 11 and 13 are not crossed off
+// one by one: each segment starts as a copy of a precomputed pattern
+// with them already cleared.
+class SegmentedSieve {
+public:
+    static const uint64_t SEGMENT_WORDS = 32 * 1024 / sizeof(uint64_t);
+    static const uint64_t SEGMENT_BITS = SEGMENT_WORDS * 64;
+
+    explicit SegmentedSieve(uint64_t N) : m_n(N) {
+        // The pattern of odd numbers with no factor up to 13 repeats
+        // every 3 * 5 * 7 * 11 * 13 bits, so every 15015 words
+        m_pattern.assign(PATTERN_PERIOD, ~uint64_t(0));
+        for (uint64_t p : PATTERN_PRIMES) {
+            for (uint64_t i = (p - 1) / 2; i < 64 * PATTERN_PERIOD; i += p) {
+                m_pattern[i / 64] &= ~(uint64_t(1) << (i % 64));
+            }
+        }
+
+        // The base primes: the odd primes from 17 up to sqrt(N), from a
+        // plain sieve
+        uint64_t root = isqrt(N);
+        vector<bool> composite(root + 1, false);
+        for (uint64_t i = 3; i <= root; i += 2) {
+            if (!composite[i]) {
+                if (i > PATTERN_PRIMES[PATTERN_COUNT - 1]) {
+                    m_primes.push_back(uint32_t(i));
+                }
+                for (uint64_t j = i * i; j <= root; j += 2 * i) {
+                    composite[j] = true;
+                }
+            }
+        }
+    }
+
+    // The number of bits (odd numbers) from 1 up to N
+    uint64_t bits() const {
+        return m_n == 0 ? 0 : (m_n - 1) / 2 + 1;
+    }
+
+    uint64_t segments() const {
+        return (bits() + SEGMENT_BITS - 1) / SEGMENT_BITS;
+    }
+
+    // Sieve segments [first, last) in order, calling
+    //   visit(firstBit, words, nBits)
+    // for each one, where bit b of words (b < nBits) is set if and only
+    // if 2 * (firstBit + b) + 1 is prime. Bits past nBits are clear.
+    template<typename Visit>
+    void sieve(uint64_t first, uint64_t last, Visit visit) const {
+        vector<uint64_t> words(SEGMENT_WORDS);
+        // Where each base prime next crosses off, relative to the
+        // current segment
+        vector<uint64_t> next(m_primes.size());
+        uint64_t firstBit = first * SEGMENT_BITS;
+        for (size_t k = 0; k < m_primes.size(); ++k) {
+            uint64_t p = m_primes[k];
+            // The first odd multiple of p past p * p and in the segment
+            uint64_t low = 2 * firstBit + 1;
+            uint64_t m = p * p;
+            if (m < low) {
+                m = (low + p - 1) / p * p;
+                if (m % 2 == 0) {
+                    m += p;
+                }
+            }
+            next[k] = (m - 1) / 2 - firstBit;
+        }
+
+        for (uint64_t segment = first; segment < last; ++segment) {
+            firstBit = segment * SEGMENT_BITS;
+            uint64_t nBits = bits() - firstBit;
+            if (nBits > SEGMENT_BITS) {
+                nBits = SEGMENT_BITS;
+            }
+
+            uint64_t patternWord = (firstBit / 64) % PATTERN_PERIOD;
+            for (uint64_t w = 0; w < SEGMENT_WORDS; ++w) {
+                words[w] = m_pattern[patternWord];
+                if (++patternWord == PATTERN_PERIOD) {
+                    patternWord = 0;
+                }
+            }
+            if (segment == 0) {
+                // 1 is not prime, but the pattern's own primes are
+                words[0] &= ~uint64_t(1);
+                for (uint64_t p : PATTERN_PRIMES) {
+                    words[0] |= uint64_t(1) << ((p - 1) / 2);
+                }
+            }
+
+            for (size_t k = 0; k < m_primes.size(); ++k) {
+                uint64_t p = m_primes[k];
+                uint64_t j = next[k];
+                for (; j < SEGMENT_BITS; j += p) {
+                    words[j / 64] &= ~(uint64_t(1) << (j % 64));
+                }
+                next[k] = j - SEGMENT_BITS;
+            }
+
+            // Clear the bits past N in the last segment
+            if (nBits < SEGMENT_BITS) {
+                if (nBits % 64 != 0) {
+                    words[nBits / 64] &= (uint64_t(1) << (nBits % 64)) - 1;
+                }
+                for (uint64_t w = (nBits + 63) / 64; w < SEGMENT_WORDS; ++w) {
+                    words[w] = 0;
+                }
+            }
+
+            visit(firstBit, words.data(), nBits);
+        }
+    }
+
+private:
+    static const uint64_t PATTERN_COUNT = 5;
+    static constexpr uint64_t PATTERN_PRIMES[PATTERN_COUNT] = { 3, 5, 7, 11, 13 };
+    static const uint64_t PATTERN_PERIOD = 3 * 5 * 7 * 11 * 13;
+
+    uint64_t m_n;
+    vector<uint32_t> m_primes;
+    vector<uint64_t> m_pattern;
+};
+
+// Call f(t) on threads t = 0 .. threads - 1, and wait for them all.
+template<typename F>
+void
+runThreads (unsigned threads, F f) {
+    if (threads <= 1) {
+        f(0);
+        return;
+    }
+    vector<std::thread> workers;
+    for (unsigned t = 0; t < threads; ++t) {
+        workers.emplace_back(f, t);
+    }
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+};
+
+// Append the primes in segments [first, last) of "sieve" to "primes".
+void
+collectPrimes (const SegmentedSieve& sieve, uint64_t first, uint64_t last,
+               vector<uint64_t>& primes) {
+    sieve.sieve(first, last,
+                [&](uint64_t firstBit, const uint64_t* words, uint64_t nBits) {
+        for (uint64_t w = 0; w < (nBits + 63) / 64; ++w) {
+            // Take the set bits lowest first
+            for (uint64_t bits = words[w]; bits != 0; bits &= bits - 1) {
+                uint64_t b = 64 * w + uint64_t(__builtin_ctzll(bits));
+                primes.push_back(2 * (firstBit + b) + 1);
+            }
+        }
+    });
+}
+
+// Return the primes between 2 and N, in order.
+// Uses the segmented sieve, so the only memory beyond the answer is one
+//   segment per thread and the primes up to sqrt(N).
+// With more than one thread, each thread sieves its own run of
+//   consecutive segments into its own vector, sharing only the base
+//   primes; then each copies its primes to their place in the answer.
+vector<uint64_t>
+sieveSegmented (uint64_t N, unsigned threads = 1) {
+    vector<uint64_t> primes;
+    if (N < 2) {
+        return primes;
+    }
+    primes.push_back(2);
+    SegmentedSieve sieve(N);
+    uint64_t segments = sieve.segments();
+    if (threads > segments) {
+        threads = unsigned(segments);
+    }
+    if (threads <= 1) {
+        collectPrimes(sieve, 0, segments, primes);
+        return primes;
+    }
+
+    vector<vector<uint64_t>> parts(threads);
+    runThreads(threads, [&](unsigned t) {
+        collectPrimes(sieve, segments * t / threads,
+                      segments * (t + 1) / threads, parts[t]);
+    });
+
+    // Thread t's primes start after those of threads 0 .. t - 1
+    vector<size_t> offsets(threads + 1, primes.size());
+    for (unsigned t = 0; t < threads; ++t) {
+        offsets[t + 1] = offsets[t] + parts[t].size();
+    }
+    primes.resize(offsets[threads]);
+    runThreads(threads, [&](unsigned t) {
+        std::copy(parts[t].begin(), parts[t].end(), primes.begin() + ptrdiff_t(offsets[t]));
+        vector<uint64_t>().swap(parts[t]);
+    });
+    return primes;
+};
+
+// Return the number of primes between 2 and N, without storing them:
+//   the segmented sieve's segments are popcounted and thrown away, so
+//   memory is O(sqrt(N)) per thread.
+uint64_t
+countPrimes (uint64_t N, unsigned threads = 1) {
+    if (N < 2) {
+        return 0;
+    }
+    SegmentedSieve sieve(N);
+    uint64_t segments = sieve.segments();
+    if (threads > segments) {
+        threads = unsigned(segments);
+    }
+    vector<uint64_t> counts(threads);
+    runThreads(threads, [&](unsigned t) {
+        uint64_t count = 0;
+        sieve.sieve(segments * t / threads, segments * (t + 1) / threads,
+                    [&](uint64_t, const uint64_t* words, uint64_t nBits) {
+            for (uint64_t w = 0; w < (nBits + 63) / 64; ++w) {
+                count += uint64_t(__builtin_popcountll(words[w]));
+            }
+        });
+        counts[t] = count;
+    });
+    // 2, which the sieve of odd numbers leaves out
+    uint64_t total = 1;
+    for (uint64_t count : counts) {
+        total += count;
+    }
+    return total;
+};
+
+// Return the number of primes between 2 and N in O(N^(3/4)) time and
+//   O(sqrt(N)) memory, without sieving up to N (the Meissel-Lucy
+//   method, as popularized by Lucy_Hedgehog).
+// S(v) counts the numbers in [2, v] not crossed off by the primes seen
+//   so far; only the sqrt(N) values v = i and v = N / i are ever
+//   needed. Sieving by each prime p <= sqrt(N) removes the numbers
+//   whose least prime factor is p:
+//     S(v) -= S(v / p) - S(p - 1)    for every v >= p * p
+//   and at the end S(N) = pi(N).
+uint64_t
+countPrimesLucy (uint64_t N) {
+    if (N < 2) {
+        return 0;
+    }
+    uint64_t r = isqrt(N);
+    // small[v] = S(v) for v <= r; large[i] = S(N / i) for i <= r
+    vector<uint64_t> small(r + 1);
+    vector<uint64_t> large(r + 1);
+    for (uint64_t v = 1; v <= r; ++v) {
+        small[v] = v - 1;
+        large[v] = N / v - 1;
+    }
+    for (uint64_t p = 2; p <= r; ++p) {
+        if (small[p] == small[p - 1]) {
+            // p was crossed off, so it is not prime
+            continue;
+        }
+        uint64_t below = small[p - 1];
+        uint64_t square = p * p;
+        uint64_t end = N / square < r ? N / square : r;
+        for (uint64_t i = 1; i <= end; ++i) {
+            uint64_t d = i * p;
+            uint64_t s = d <= r ? large[d] : small[N / d];
+            large[i] -= s - below;
+        }
+        for (uint64_t v = r; v >= square; --v) {
+            small[v] -= small[v / p] - below;
+        }
+    }
+    return large[1];
+};
+
 int main (int argc, char* argv[]) {
-    std::string version{argv[1]};
-    unsigned int number = std::stoul (std::string{argv[2]});
-    auto sieveVersion = (version == "set" ? &sieveSet : &sieveVector);
+    unsigned threads = 1;
+    int arg = 1;
+    if (argc > 2 && string{argv[1]} == "--threads") {
+        threads = unsigned(std::stoul (string{argv[2]}));
+        arg = 3;
+    }
+    if (argc - arg < 2 || threads == 0) {
+        std::cerr << "usage: " << argv[0] << " [--threads T] set|vector|segmented|count|lucy N" << std::endl;
+        return 1;
+    }
+    std::string version{argv[arg]};
+    uint64_t number = std::stoull (std::string{argv[arg + 1]});
+    uint64_t count;
     Timer<> t;
-    set<unsigned> answer = sieveVersion (number);
+    if (version == "segmented") {
+        vector<uint64_t> answer = sieveSegmented (number, threads);
+        count = answer.size();
+    } else if (version == "count") {
+        count = countPrimes (number, threads);
+    } else if (version == "lucy") {
+        count = countPrimesLucy (number);
+    } else {
+        if (number > UINT_MAX) {
+            std::cerr << "the " << version << " sieve only goes up to " << UINT_MAX << std::endl;
+            return 1;
+        }
+        auto sieveVersion = (version == "set" ? &sieveSet : &sieveVector);
+        set<unsigned> answer = sieveVersion (unsigned(number));
+        count = answer.size();
+    }
     t.stop();
-    std::cout << "Pi[" << number << "] = " << answer.size() << " (using a " << version << ")" << std::endl;
+    std::cout << "Pi[" << number << "] = " << count << " (using a " << version << ")" << std::endl;
     std::cout << "Time: " << t.getElapsedMs() << " ms"<<std::endl;
 }
 /*
@@ -2,16 +2,48 @@
 #define DIVIDE_AND_CONQUER_HPP_
 
 #include <algorithm>
+#include <cstddef>
+#include <functional>
 #include <iterator>
+#include <type_traits>
 #include <utility>
 #include <vector>
 
+#include "PartitionSimd.hpp"
+
 // NOTE: you are forbidden from using anything from <algorithm> for this assignment
 //       EXCEPT for std::copy
 
 namespace SortUtils
 {
 
+// Every algorithm here takes an optional comparator and projection:
+// elements are compared as comp (proj (a), proj (b)), so records can
+// be sorted in place by one of their fields. "proj" may also be a
+// pointer to member. The defaults compare whole elements with <
+//
+struct identity
+{
+  template<typename T>
+  constexpr T&&
+  operator() (T&& x) const noexcept
+  {
+    return std::forward<T> (x);
+  }
+};
+
+// Whether T is an iterator rather than a comparator, to tell the
+// merge_sort overloads apart. A function pointer has iterator_traits
+// too, but dereferences to a function rather than an object
+template<typename T, typename = void>
+constexpr bool is_iterator_v = false;
+
+template<typename T>
+constexpr bool is_iterator_v<
+  T, std::void_t<typename std::iterator_traits<T>::iterator_category,
+                 decltype (*std::declval<T&> ())>> =
+  std::is_object_v<std::remove_reference_t<decltype (*std::declval<T&> ())>>;
+
 // [9]
 // Given a RandomAccessRange [first, last), determine where the "midpoint"
 // would be and perform the following steps:
@@ -20,19 +52,22 @@ namespace SortUtils
 //
 // returns an iterator to mid -- a.k.a. the median
 //
-template<typename Iter>
+template<typename Iter, typename Compare = std::less<>, typename Proj = identity>
 Iter
-median3 (Iter first, Iter last)
+median3 (Iter first, Iter last, Compare comp = {}, Proj proj = {})
 {
   int distance = std::distance(first, last);
   auto mid = first + distance/2;
-  if(*first > *mid) {
+  auto const greater = [&] (Iter a, Iter b) {
+    return comp (std::invoke (proj, *b), std::invoke (proj, *a));
+  };
+  if(greater(first, mid)) {
     std::swap(*first, *mid);
   }
-  if(*mid > *std::prev(last)) {
+  if(greater(mid, std::prev(last))) {
     std::swap(*mid, *std::prev(last));
   }
-  if(*first > *mid) {
+  if(greater(first, mid)) {
     std::swap(*first, *mid);
   }
   return mid;
@@ -45,34 +80,33 @@ median3 (Iter first, Iter last)
 //
 // Returns the iterator of one-past-the-last where we wrote to out
 //
-template<typename Iter1, typename Iter2, typename OIter>
+template<typename Iter1, typename Iter2, typename OIter,
+         typename Compare = std::less<>, typename Proj = identity>
 OIter
-merge (Iter1 first1, Iter1 last1, Iter2 first2, Iter2 last2, OIter out)
+merge (Iter1 first1, Iter1 last1, Iter2 first2, Iter2 last2, OIter out,
+       Compare comp = {}, Proj proj = {})
 {
-  //if we got to the end for both iterators, return out
-  if(first1 == last1 && first2 == last2){
-    return out;
-  }
-
-  //If JUST first1 == last1 or the other way around, we assume that the rest of the
-  //other list is sorted and we can insert it into out as is, then return out.
-  if(first1 == last1) {
-    return std::copy(first2, last2, out); 
-  } else if(first2 == last2) {
-    return std::copy(first1, last1, out);
-  }
-
-  if(*first1 < *first2) {
-    *out = *first1;
-    ++out;
-    ++first1;
-  } else {
-    *out = *first2;
+  // one loop iteration per element written -- no recursion, so the
+  // stack stays flat however long the ranges are. On ties the element
+  // from the first range goes first, which keeps merge_sort stable
+  while (first1 != last1 && first2 != last2)
+  {
+    if (comp (std::invoke (proj, *first2), std::invoke (proj, *first1)))
+    {
+      *out = *first2;
+      ++first2;
+    }
+    else
+    {
+      *out = *first1;
+      ++first1;
+    }
     ++out;
-    ++first2;
   }
 
-  return SortUtils::merge(first1, last1, first2, last2, out);
+  // whatever is left of either range is already sorted
+  out = std::copy (first1, last1, out);
+  return std::copy (first2, last2, out);
 }
 
 // [15]
@@ -89,23 +123,29 @@ merge (Iter1 first1, Iter1 last1, Iter2 first2, Iter2 last2, OIter out)
 //
 // Returns a pair of iterators pointing to "p1" and "p2" above
 //
-template<typename Iter, typename Value>
+// "pivot" is a key: elements are compared as comp (proj (x), pivot)
+//
+template<typename Iter, typename Value, typename Compare = std::less<>,
+         typename Proj = identity>
 std::pair<Iter, Iter>
-partition (Iter first, Iter last, Value const& pivot)
+partition (Iter first, Iter last, Value const& pivot, Compare comp = {},
+           Proj proj = {})
 {
+  auto const less = [&] (Iter x) { return comp (std::invoke (proj, *x), pivot); };
+  auto const greater = [&] (Iter x) { return comp (pivot, std::invoke (proj, *x)); };
   Iter lo = first;
   Iter eq = first;
   Iter hi = --last;
 
   while(eq != hi) {
     //case 1: *eq < pivot
-    if(*eq < pivot) {
+    if(less(eq)) {
       std::swap(*lo, *eq);
       ++lo;
       ++eq;
     } 
     // case 2: *eq > pivot
-    else if (*eq > pivot) {
+    else if (greater(eq)) {
       std::swap(*hi, *eq);
       --hi;
     } 
@@ -115,10 +155,10 @@ partition (Iter first, Iter last, Value const& pivot)
     }
   }
 
-  if(*eq < pivot) {
+  if(less(eq)) {
     std::swap(*lo, *eq);
     ++lo;
-  } else if(*eq > pivot) {
+  } else if(greater(eq)) {
     std::swap(*hi, *eq);
     --hi;
   } 
@@ -128,8 +168,160 @@ partition (Iter first, Iter last, Value const& pivot)
   return std::make_pair(lo, hi);
 }
 
+// Side blocks of this many elements are scanned by block_partition
+constexpr std::ptrdiff_t PARTITION_BLOCK = 64;
+
+// Given a RandomAccessRange, move every element for which "goesLeft"
+// is true before every element for which it is false. Returns the
+// first of the latter. Not stable
+//
+// BlockQuicksort's scheme: scan a block from each end, recording the
+// offsets of the elements on the wrong side without branching on the
+// comparison, then swap them off in pairs. The only branches left are
+// the loop's, so a random pivot costs no mispredictions
+//
+// Kept out of line: inlined into introsort_loop, its loops come out
+// about 25% slower with GCC
+//
+template<typename Iter, typename Pred>
+[[gnu::noinline]] Iter
+block_partition (Iter first, Iter last, Pred goesLeft)
+{
+  unsigned char offsetsL[PARTITION_BLOCK];
+  unsigned char offsetsR[PARTITION_BLOCK];
+  std::ptrdiff_t startL = 0, numL = 0, startR = 0, numR = 0;
+  while (last - first > 2 * PARTITION_BLOCK)
+  {
+    if (numL == 0)
+    {
+      startL = 0;
+      for (std::ptrdiff_t i = 0; i < PARTITION_BLOCK; ++i)
+      {
+        offsetsL[numL] = static_cast<unsigned char> (i);
+        numL += !goesLeft (first[i]);
+      }
+    }
+    if (numR == 0)
+    {
+      startR = 0;
+      for (std::ptrdiff_t i = 0; i < PARTITION_BLOCK; ++i)
+      {
+        offsetsR[numR] = static_cast<unsigned char> (i);
+        numR += goesLeft (*(last - 1 - i));
+      }
+    }
+    std::ptrdiff_t const num = numL < numR ? numL : numR;
+    for (std::ptrdiff_t j = 0; j < num; ++j)
+    {
+      std::iter_swap (first + offsetsL[startL + j],
+                      last - 1 - offsetsR[startR + j]);
+    }
+    numL -= num;
+    numR -= num;
+    startL += num;
+    startR += num;
+    // a block is done once it has no misplaced elements left
+    if (numL == 0)
+    {
+      first += PARTITION_BLOCK;
+    }
+    if (numR == 0)
+    {
+      last -= PARTITION_BLOCK;
+    }
+  }
+
+  // under three blocks left: finish one element at a time
+  for (Iter i = first; i != last; ++i)
+  {
+    if (goesLeft (*i))
+    {
+      std::iter_swap (i, first);
+      ++first;
+    }
+  }
+  return first;
+}
+
+// Whether Iter walks an array, so &*first is a plain pointer to it
+template<typename Iter>
+constexpr bool is_contiguous_v =
+  std::is_pointer_v<Iter>
+  || std::is_same_v<Iter, typename std::vector<
+                            typename std::iterator_traits<Iter>::value_type>::iterator>;
+
+// The same three groups as partition, found in two passes of
+// block_partition (< pivot, then == pivot) rather than one branchy
+// pass. Arrays of numbers compared with the defaults go to
+// PartitionSimd's vector kernels instead. quick_sort and nth_element
+// partition with this
+//
+template<typename Iter, typename Value, typename Compare = std::less<>,
+         typename Proj = identity>
+std::pair<Iter, Iter>
+fast_partition (Iter first, Iter last, Value const& pivot, Compare comp = {},
+                Proj proj = {})
+{
+  using T = typename std::iterator_traits<Iter>::value_type;
+
+  if constexpr (is_contiguous_v<Iter> && PartitionSimd::has_kernel<T>
+                && std::is_same_v<Value, T>
+                && std::is_same_v<Compare, std::less<>>
+                && std::is_same_v<Proj, identity>)
+  {
+    std::size_t const N = std::distance (first, last);
+    if (N >= PartitionSimd::MIN_SIZE && PartitionSimd::available<T> ())
+    {
+      T* const a = &*first;
+      std::size_t const less = PartitionSimd::partition (a, N, pivot, false);
+      std::size_t const equal =
+        PartitionSimd::partition (a + less, N - less, pivot, true);
+      return std::make_pair (first + less, first + less + equal);
+    }
+  }
+  Iter p1 = SortUtils::block_partition (first, last, [&] (auto const& x) {
+    return comp (std::invoke (proj, x), pivot);
+  });
+  Iter p2 = SortUtils::block_partition (p1, last, [&] (auto const& x) {
+    return !comp (pivot, std::invoke (proj, x));
+  });
+  return std::make_pair (p1, p2);
+}
+
+// Given a RandomAccessRange, sort using insertion sort
+//
+// O(N^2), but the fastest choice for a handful of elements: quick_sort
+// and merge_sort leave their smallest ranges to it
+//
+template<typename Iter, typename Compare = std::less<>, typename Proj = identity>
+void
+insertion_sort (Iter first, Iter last, Compare comp = {}, Proj proj = {})
+{
+  for (Iter i = first; i != last; ++i)
+  {
+    // shift the larger elements up one slot and drop the value into
+    // the hole, rather than swapping it down one step at a time
+    auto value = std::move (*i);
+    Iter j = i;
+    for (; j != first
+           && comp (std::invoke (proj, value), std::invoke (proj, *(j - 1)));
+         --j)
+    {
+      *j = std::move (*(j - 1));
+    }
+    *j = std::move (value);
+  }
+}
+
+// Partitions this small are left to insertion_sort
+constexpr std::ptrdiff_t INSERTION_SORT_THRESHOLD = 16;
+
+template<typename Iter, typename Compare, typename Proj>
+Iter
+median_of_medians (Iter first, Iter last, Compare comp, Proj proj);
+
 // [10]
-// Given a RandomAccessRange, recursively call partition on either the
+// Given a RandomAccessRange, repeatedly call partition on either the
 // left half or right half until you have found the nth largest element
 //
 // A call to nth_element (v.begin(), v.end(), 0) will return the min
@@ -146,30 +338,159 @@ partition (Iter first, Iter last, Value const& pivot)
 //  - call median3 to get a pivot value
 //  - when calling partition, remember to dereference the iterator returns by median3
 //
-template<typename Iter>
+// Runs as an introselect, in a loop rather than recursing: pivots come
+// from median3, except that whenever three partitions in a row fail to
+// halve the range, the next pivot comes from median_of_medians. Every
+// four rounds then shrink the range by a constant factor, so the worst
+// case is O(N) rather than O(N^2)
+//
+template<typename Iter, typename Compare = std::less<>, typename Proj = identity>
+Iter
+nth_element (Iter first, Iter last, size_t n, Compare comp = {}, Proj proj = {})
+{
+  Iter const nth = first + n;
+  // every three rounds must halve the range; a round that follows
+  // three that didn't picks its pivot with median_of_medians
+  std::ptrdiff_t checkpoint = std::distance(first, last);
+  int rounds = 0;
+
+  while (std::distance(first, last) > INSERTION_SORT_THRESHOLD) {
+    bool linear = false;
+    if (++rounds > 3) {
+      linear = 2 * std::distance(first, last) > checkpoint;
+      checkpoint = std::distance(first, last);
+      rounds = 0;
+    }
+    Iter const median = linear
+      ? SortUtils::median_of_medians(first, last, comp, proj)
+      : SortUtils::median3(first, last, comp, proj);
+    // a copy of the pivot's key: the pivot itself moves while partitioning
+    auto const pivot = std::invoke (proj, *median);
+    auto [p1, p2] = SortUtils::fast_partition (first, last, pivot, comp, proj);
+
+    //case 1: if n is in range first, p1
+    if(nth < p1) {
+      last = p1;
+    }
+    //case 2: if n is in p1, p2
+    // return nth iter
+    else if (nth < p2) {
+      return nth;
+    }
+    //case 3: if n is in the range p2, last
+    else {
+      first = p2;
+    }
+  }
+  SortUtils::insertion_sort (first, last, comp, proj);
+  return nth;
+}
+
+// Groups of this many elements give median_of_medians its pivots
+constexpr std::ptrdiff_t MEDIAN_GROUP = 5;
+
+// Return a pivot with at least 3/10 of [first, last) on either side:
+// sort each group of five, gather the groups' medians at the front of
+// the range, and select their median with nth_element. O(N), and
+// leaves the range in a different order
+//
+template<typename Iter, typename Compare, typename Proj>
 Iter
-nth_element (Iter first, Iter last, size_t n)
+median_of_medians (Iter first, Iter last, Compare comp, Proj proj)
 {
-  if (std::distance(first, last) < 2) {
-    return first;
+  Iter medians = first;
+  for (Iter group = first; group != last; )
+  {
+    Iter const end =
+      last - group > MEDIAN_GROUP ? group + MEDIAN_GROUP : last;
+    SortUtils::insertion_sort (group, end, comp, proj);
+    std::iter_swap (medians, group + (end - group) / 2);
+    ++medians;
+    group = end;
   }
-  auto const pivot = *SortUtils::median3(first, last);
-  auto [p1, p2] = SortUtils::partition (first, last, pivot);
+  return SortUtils::nth_element (first, medians, (medians - first) / 2, comp,
+                                 proj);
+}
+
+// Runs this short are sorted by insertion_sort before merge_sort
+// starts merging
+constexpr std::ptrdiff_t MERGE_SORT_RUN = 32;
 
-  //case 1: if n is in range first, p1
-  //recursive
-  if(n < std::distance(first, p1)) {
-    return nth_element(first, p1, n);
+// One bottom-up merge_sort pass: merge each pair of neighbouring
+// sorted runs of length "width" from [src, src + N) into dst. Elements
+// are moved, not copied
+//
+template<typename SrcIter, typename DstIter, typename Compare, typename Proj>
+void
+merge_pass (SrcIter src, std::ptrdiff_t N, std::ptrdiff_t width, DstIter dst,
+            Compare comp, Proj proj)
+{
+  for (std::ptrdiff_t lo = 0; lo < N; lo += 2 * width)
+  {
+    std::ptrdiff_t const mid = lo + width < N ? lo + width : N;
+    std::ptrdiff_t const hi = mid + width < N ? mid + width : N;
+    SortUtils::merge (std::make_move_iterator (src + lo),
+                      std::make_move_iterator (src + mid),
+                      std::make_move_iterator (src + mid),
+                      std::make_move_iterator (src + hi), dst + lo, comp,
+                      proj);
   }
-  //case 2: if n is in p1, p2
-  // return nth iter
-  else if (n < std::distance(first,p2)) {
-    return first + n;
+}
+
+// merge_sort's passes over [first, first + N), with "buffer" as the
+// other half of the ping-pong. Returns whether the sorted result ended
+// up in the buffer instead of the range
+//
+template<typename Iter, typename BufIter, typename Compare, typename Proj>
+bool
+merge_sort_passes (Iter first, std::ptrdiff_t N, BufIter buffer, Compare comp,
+                   Proj proj)
+{
+  for (std::ptrdiff_t lo = 0; lo < N; lo += MERGE_SORT_RUN)
+  {
+    SortUtils::insertion_sort (first + lo, N - lo < MERGE_SORT_RUN
+                                             ? first + N
+                                             : first + lo + MERGE_SORT_RUN,
+                                 comp, proj);
   }
-  //case 3: if n is in the range p2, last
-  //recursive
-  else {
-    return nth_element(p2, last, n - std::distance(first, p2));
+
+  bool inBuffer = false;
+  for (std::ptrdiff_t width = MERGE_SORT_RUN; width < N; width *= 2)
+  {
+    if (inBuffer)
+    {
+      SortUtils::merge_pass (buffer, N, width, first, comp, proj);
+    }
+    else
+    {
+      SortUtils::merge_pass (first, N, width, buffer, comp, proj);
+    }
+    inBuffer = !inBuffer;
+  }
+  return inBuffer;
+}
+
+// Given a RandomAccessRange, sort using merge sort, with "buffer" (a
+// RandomAccessIterator to at least N assignable elements) as scratch
+// space. Nothing is allocated
+//
+// Bottom-up: insertion sort runs of MERGE_SORT_RUN, then merge runs of
+// doubling width, alternating between the range and the buffer so no
+// pass has to copy its result back. Stable
+//
+template<typename Iter, typename BufIter, typename Compare = std::less<>,
+         typename Proj = identity,
+         std::enable_if_t<is_iterator_v<BufIter>, int> = 0>
+void
+merge_sort (Iter first, Iter last, BufIter buffer, Compare comp = {},
+            Proj proj = {})
+{
+  const std::ptrdiff_t N = std::distance (first, last);
+  // at most one copy back, after the last pass
+  if (SortUtils::merge_sort_passes (first, N, buffer, comp, proj))
+  {
+    std::copy (std::make_move_iterator (buffer),
+               std::make_move_iterator (buffer + N), first);
   }
 }
 
@@ -182,26 +503,253 @@ nth_element (Iter first, Iter last, size_t n)
 // Hints:
 //   - You will need a vector to act as a temporary buffer.
 //
-template<typename Iter>
+// Allocates a single buffer for the whole sort. Elements are moved,
+// never copied
+//
+template<typename Iter, typename Compare = std::less<>, typename Proj = identity,
+         std::enable_if_t<!is_iterator_v<Compare>, int> = 0>
 void
-merge_sort (Iter first, Iter last)
+merge_sort (Iter first, Iter last, Compare comp = {}, Proj proj = {})
 {
-  const size_t N = std::distance(first, last);
-  Iter mid = first + N/2;
+  // T is the type of data we are sorting
   using T = std::remove_reference_t<decltype (*std::declval<Iter> ())>;
 
-  //Base
-  if(N < 2) {
+  if (std::distance (first, last) < 2)
+  {
     return;
-  } 
+  }
+  // sort in the buffer with the range as scratch, then move the result
+  // back only if it ended up in the buffer
+  std::vector<T> buf (std::make_move_iterator (first),
+                      std::make_move_iterator (last));
+  if (!SortUtils::merge_sort_passes (buf.begin (), std::ptrdiff_t (buf.size ()),
+                                     first, comp, proj))
+  {
+    std::copy (std::make_move_iterator (buf.begin ()),
+               std::make_move_iterator (buf.end ()), first);
+  }
+}
+
+// Given a heap stored in [first, first + n) where only the element at
+// "hole" may be out of place, move it down until its children are no
+// larger than it
+//
+template<typename Iter, typename Compare, typename Proj>
+void
+sift_down (Iter first, std::ptrdiff_t hole, std::ptrdiff_t n, Compare comp,
+           Proj proj)
+{
+  auto const less = [&] (auto const& a, auto const& b) {
+    return comp (std::invoke (proj, a), std::invoke (proj, b));
+  };
+  auto value = std::move (first[hole]);
+  for (std::ptrdiff_t child = 2 * hole + 1; child < n; child = 2 * hole + 1)
+  {
+    if (child + 1 < n && less (first[child], first[child + 1]))
+    {
+      ++child;
+    }
+    if (!less (value, first[child]))
+    {
+      break;
+    }
+    first[hole] = std::move (first[child]);
+    hole = child;
+  }
+  first[hole] = std::move (value);
+}
+
+// Arrange first[0, n) into a max-heap, in O(n)
+//
+template<typename Iter, typename Compare, typename Proj>
+void
+make_heap (Iter first, std::ptrdiff_t n, Compare comp, Proj proj)
+{
+  for (std::ptrdiff_t i = n / 2; i-- > 0; )
+  {
+    SortUtils::sift_down (first, i, n, comp, proj);
+  }
+}
+
+// Sort the max-heap first[0, n) in place, in O(n log n)
+//
+template<typename Iter, typename Compare, typename Proj>
+void
+sort_heap (Iter first, std::ptrdiff_t n, Compare comp, Proj proj)
+{
+  for (std::ptrdiff_t end = n - 1; end > 0; --end)
+  {
+    std::iter_swap (first, first + end);
+    SortUtils::sift_down (first, 0, end, comp, proj);
+  }
+}
+
+// Given a RandomAccessRange, sort using heap sort
+//
+// O(N log N) in the worst case with no extra memory, which makes it
+// quick_sort's fallback when partitioning keeps going badly
+//
+template<typename Iter, typename Compare = std::less<>, typename Proj = identity>
+void
+heap_sort (Iter first, Iter last, Compare comp = {}, Proj proj = {})
+{
+  const std::ptrdiff_t N = std::distance (first, last);
+  SortUtils::make_heap (first, N, comp, proj);
+  SortUtils::sort_heap (first, N, comp, proj);
+}
+
+// Given a RandomAccessRange, put its smallest "middle - first"
+// elements in order in [first, middle); the rest end up in
+// [middle, last) in no particular order
+//
+// [first, middle) is kept as a max-heap of the smallest elements seen
+// so far, and each later element that beats its top replaces it.
+// O(N log K) for K = middle - first, with no extra memory
+//
+template<typename Iter, typename Compare = std::less<>, typename Proj = identity>
+void
+partial_sort (Iter first, Iter middle, Iter last, Compare comp = {},
+              Proj proj = {})
+{
+  const std::ptrdiff_t K = std::distance (first, middle);
+  if (K == 0)
+  {
+    return;
+  }
+  SortUtils::make_heap (first, K, comp, proj);
+  for (Iter i = middle; i != last; ++i)
+  {
+    if (comp (std::invoke (proj, *i), std::invoke (proj, *first)))
+    {
+      std::iter_swap (i, first);
+      SortUtils::sift_down (first, 0, K, comp, proj);
+    }
+  }
+  SortUtils::sort_heap (first, K, comp, proj);
+}
+
+// Offer "value" to "heap", a max-heap of the "k" smallest elements
+// seen so far: it replaces the top if it is smaller
+//
+template<typename Iter, typename Value, typename Compare, typename Proj>
+void
+heap_offer (Iter heap, std::ptrdiff_t k, Value&& value, Compare comp, Proj proj)
+{
+  if (comp (std::invoke (proj, value), std::invoke (proj, *heap)))
+  {
+    *heap = std::forward<Value> (value);
+    SortUtils::sift_down (heap, 0, k, comp, proj);
+  }
+}
 
-  // Recursive
-  SortUtils::merge_sort(first, mid);
-  SortUtils::merge_sort(mid, last);
-  std::vector<T> buf (N);
-  SortUtils::merge(first, mid, mid, last, buf.begin());
+// Given an InputRange [first, last), copy its smallest elements, in
+// order, to the RandomAccessRange [dFirst, dLast) -- as many as fit,
+// or all of them if fewer. Returns the end of what was written
+//
+// Reads the input once, so it works on streams. O(N log K) for K =
+// dLast - dFirst
+//
+template<typename InIter, typename RandIter, typename Compare = std::less<>,
+         typename Proj = identity>
+RandIter
+partial_sort_copy (InIter first, InIter last, RandIter dFirst, RandIter dLast,
+                   Compare comp = {}, Proj proj = {})
+{
+  const std::ptrdiff_t K = std::distance (dFirst, dLast);
+  if (K == 0)
+  {
+    return dFirst;
+  }
+  std::ptrdiff_t n = 0;
+  for (; n < K && first != last; ++first, ++n)
+  {
+    dFirst[n] = *first;
+  }
+  SortUtils::make_heap (dFirst, n, comp, proj);
+  for (; first != last; ++first)
+  {
+    SortUtils::heap_offer (dFirst, n, *first, comp, proj);
+  }
+  SortUtils::sort_heap (dFirst, n, comp, proj);
+  return dFirst + n;
+}
 
-  std::copy_n (buf.begin(), N, first);
+// Given an InputRange [first, last), return its "k" smallest elements
+// (or all of them, if fewer) in order. With std::greater<> that is the
+// k largest, largest first
+//
+// Streams: the input is read once and only the k best so far are
+// kept, so it takes O(k) memory and O(N log k) time however long the
+// input is
+//
+template<typename InIter, typename Compare = std::less<>, typename Proj = identity>
+std::vector<typename std::iterator_traits<InIter>::value_type>
+top_k (InIter first, InIter last, std::size_t k, Compare comp = {},
+       Proj proj = {})
+{
+  std::vector<typename std::iterator_traits<InIter>::value_type> best;
+  if (k == 0)
+  {
+    return best;
+  }
+  for (; best.size () < k && first != last; ++first)
+  {
+    best.push_back (*first);
+  }
+  const std::ptrdiff_t K = best.size ();
+  SortUtils::make_heap (best.begin (), K, comp, proj);
+  for (; first != last; ++first)
+  {
+    SortUtils::heap_offer (best.begin (), K, *first, comp, proj);
+  }
+  SortUtils::sort_heap (best.begin (), K, comp, proj);
+  return best;
+}
+
+// Return floor (log2 (n)) for n > 0
+inline int
+log2_floor (std::size_t n)
+{
+  int log = 0;
+  while (n >>= 1)
+  {
+    ++log;
+  }
+  return log;
+}
+
+// quick_sort's loop: partition around the median of three, recurse on
+// the smaller side and keep looping on the larger one, so the stack
+// never holds more than log N frames. Once "depth" runs out the range
+// is heap sorted instead, and small ranges are left for one final
+// insertion_sort pass
+//
+template<typename Iter, typename Compare, typename Proj>
+void
+introsort_loop (Iter first, Iter last, int depth, Compare comp, Proj proj)
+{
+  while (std::distance (first, last) > INSERTION_SORT_THRESHOLD)
+  {
+    if (depth == 0)
+    {
+      SortUtils::heap_sort (first, last, comp, proj);
+      return;
+    }
+    --depth;
+    auto const pivot =
+      std::invoke (proj, *SortUtils::median3 (first, last, comp, proj));
+    auto [p1, p2] = SortUtils::fast_partition (first, last, pivot, comp, proj);
+    if (std::distance (first, p1) < std::distance (p2, last))
+    {
+      SortUtils::introsort_loop (first, p1, depth, comp, proj);
+      first = p2;
+    }
+    else
+    {
+      SortUtils::introsort_loop (p2, last, depth, comp, proj);
+      last = p1;
+    }
+  }
 }
 
 // [10]
@@ -215,43 +763,22 @@ merge_sort (Iter first, Iter last)
 //   - remember to dereference the iterator returned by median3 to get the pivot value
 //   - partition should be called
 //
-template<typename Iter>
+// Runs as an introsort: past 2 log N levels of partitioning it switches
+// to heap_sort, so the worst case is O(N log N) rather than O(N^2)
+//
+template<typename Iter, typename Compare = std::less<>, typename Proj = identity>
 void
-quick_sort (Iter first, Iter last)
+quick_sort (Iter first, Iter last, Compare comp = {}, Proj proj = {})
 {
   const auto N = std::distance(first, last);
-  // T is the type of data we are sorting
-  using T = std::remove_reference_t<decltype (*std::declval<Iter> ())>;
 
   //base
   if(N < 2) return;
-  //recursive
-  auto pivot = *SortUtils::median3(first, last);
-  auto [p1, p2] = SortUtils::partition(first, last, pivot);
-    
-  SortUtils::quick_sort(first, p1);
-  SortUtils::quick_sort(p2, last);
-  
-}
-
-template<typename Iter>
-void
-insertion_sort (Iter first, Iter last)
-{
-  for (Iter i = first; i != last; ++i)
-  {
-    for (Iter j = i; j != first; --j)
-    {
-      if (*(j - 1) > *j)
-      {
-        std::iter_swap (j - 1, j);
-      }
-      else
-      {
-        break;
-      }
-    }
-  }
+  SortUtils::introsort_loop (first, last, 2 * SortUtils::log2_floor (N), comp,
+                             proj);
+  // every element is now within its own small partition, so a single
+  // insertion sort pass finishes the job in O(N * threshold)
+  SortUtils::insertion_sort (first, last, comp, proj);
 }
 
 } // end namespace util
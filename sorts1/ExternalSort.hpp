@@ -0,0 +1,593 @@
+#ifndef EXTERNAL_SORT_HPP_
+#define EXTERNAL_SORT_HPP_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdio>
+#include <filesystem>
+#include <functional>
+#include <future>
+#include <iterator>
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "DivideAndConquer.hpp"
+
+// External merge sort, for data that does not fit in memory
+//
+// The input is read a run at a time -- as many elements as the memory
+// budget holds -- and each run is quick sorted and spilled to a
+// temporary file. The runs are then merged, as many at once as the
+// budget has read buffers for, through a loser tree; if there are more
+// runs than that, groups of them are first merged into longer runs.
+// Reads are double-buffered and writes go out in the background, one
+// large block at a time, so the disk streams while the merge compares
+//
+// Elements are copied to disk byte for byte, so T must be trivially
+// copyable. Not stable
+
+namespace SortUtils
+{
+
+struct ExternalSortOptions
+{
+  // memory for elements: each run holds this much, and the merge
+  // splits it into read buffers
+  std::size_t memoryBytes = std::size_t (256) << 20;
+  // size of each read and write
+  std::size_t blockBytes = std::size_t (4) << 20;
+  // where runs are spilled; empty means the system's temporary directory
+  std::string tempDirectory;
+};
+
+struct ExternalSortStats
+{
+  std::size_t elements = 0;
+  // sorted runs the input was cut into
+  std::size_t runs = 0;
+  // passes over the data after run generation, the final merge included
+  std::size_t mergePasses = 0;
+};
+
+// A temporary file, removed when this goes away
+class TempFile
+{
+public:
+  explicit TempFile (std::string const& directory)
+  {
+    static std::atomic<unsigned> count{0};
+    std::filesystem::path dir = directory.empty ()
+                                  ? std::filesystem::temp_directory_path ()
+                                  : std::filesystem::path (directory);
+    std::random_device random;
+    m_path = (dir / ("sortutils-run-" + std::to_string (random ()) + "-"
+                     + std::to_string (count++)))
+               .string ();
+  }
+
+  TempFile (TempFile const&) = delete;
+  TempFile& operator= (TempFile const&) = delete;
+
+  ~TempFile ()
+  {
+    std::error_code ignored;
+    std::filesystem::remove (m_path, ignored);
+  }
+
+  std::string const&
+  path () const
+  {
+    return m_path;
+  }
+
+private:
+  std::string m_path;
+};
+
+inline std::FILE*
+open_binary (std::string const& path, char const* mode)
+{
+  std::FILE* file = std::fopen (path.c_str (), mode);
+  if (file == nullptr)
+  {
+    throw std::runtime_error ("external_sort: cannot open " + path);
+  }
+  // we do our own buffering, in much larger blocks
+  std::setvbuf (file, nullptr, _IONBF, 0);
+  return file;
+}
+
+// Reads a binary file of T one element at a time, a block at a time:
+// while one block is consumed, the next is read in the background
+//
+template<typename T>
+class BlockReader
+{
+public:
+  BlockReader (std::string const& path, std::size_t blockElements)
+    : m_file (open_binary (path, "rb"), &std::fclose),
+      m_front (blockElements),
+      m_back (blockElements)
+  {
+    // the destructor won't run if we throw: let the read finish before
+    // the buffers and the file go away
+    try
+    {
+      prefetch ();
+      refill ();
+    }
+    catch (...)
+    {
+      if (m_next.valid ())
+      {
+        m_next.wait ();
+      }
+      throw;
+    }
+  }
+
+  BlockReader (BlockReader const&) = delete;
+  BlockReader& operator= (BlockReader const&) = delete;
+
+  ~BlockReader ()
+  {
+    if (m_next.valid ())
+    {
+      m_next.wait ();
+    }
+  }
+
+  bool
+  empty () const
+  {
+    return m_pos == m_size;
+  }
+
+  T const&
+  front () const
+  {
+    return m_front[m_pos];
+  }
+
+  void
+  pop ()
+  {
+    if (++m_pos == m_size)
+    {
+      refill ();
+    }
+  }
+
+private:
+  void
+  prefetch ()
+  {
+    m_next = std::async (std::launch::async, [this] {
+      return std::fread (m_back.data (), sizeof (T), m_back.size (),
+                         m_file.get ());
+    });
+  }
+
+  void
+  refill ()
+  {
+    if (!m_next.valid ())
+    {
+      m_pos = m_size = 0;
+      return;
+    }
+    m_size = m_next.get ();
+    if (std::ferror (m_file.get ()))
+    {
+      throw std::runtime_error ("external_sort: read failed");
+    }
+    m_pos = 0;
+    std::swap (m_front, m_back);
+    if (m_size == m_front.size ())
+    {
+      prefetch ();
+    }
+  }
+
+  // declared first, so it is closed after the buffers and m_next go
+  std::unique_ptr<std::FILE, decltype (&std::fclose)> m_file;
+  std::vector<T> m_front;
+  std::vector<T> m_back;
+  std::future<std::size_t> m_next;
+  std::size_t m_pos = 0;
+  std::size_t m_size = 0;
+};
+
+// Writes a binary file of T one element at a time: full blocks are
+// written in the background while the next one fills. The file is
+// created on the first write (or on close), so it may be the file the
+// input came from
+//
+template<typename T>
+class BlockWriter
+{
+public:
+  BlockWriter (std::string path, std::size_t blockElements)
+    : m_path (std::move (path)),
+      m_front (blockElements),
+      m_back (blockElements)
+  {
+  }
+
+  BlockWriter (BlockWriter const&) = delete;
+  BlockWriter& operator= (BlockWriter const&) = delete;
+
+  ~BlockWriter ()
+  {
+    if (m_pending.valid ())
+    {
+      m_pending.wait ();
+    }
+    if (m_file != nullptr)
+    {
+      std::fclose (m_file);
+    }
+  }
+
+  void
+  put (T const& value)
+  {
+    m_front[m_size++] = value;
+    if (m_size == m_front.size ())
+    {
+      flush ();
+    }
+  }
+
+  // Write what is left and close the file. Throws if any write failed
+  void
+  close ()
+  {
+    flush ();
+    wait ();
+    std::FILE* file = std::exchange (m_file, nullptr);
+    if (std::fclose (file) != 0)
+    {
+      throw std::runtime_error ("external_sort: cannot write " + m_path);
+    }
+  }
+
+private:
+  void
+  flush ()
+  {
+    wait ();
+    if (m_file == nullptr)
+    {
+      m_file = open_binary (m_path, "wb");
+    }
+    std::swap (m_front, m_back);
+    std::size_t const count = std::exchange (m_size, 0);
+    m_pending = std::async (std::launch::async, [this, count] {
+      return std::fwrite (m_back.data (), sizeof (T), count, m_file) == count;
+    });
+  }
+
+  void
+  wait ()
+  {
+    if (m_pending.valid () && !m_pending.get ())
+    {
+      throw std::runtime_error ("external_sort: cannot write " + m_path);
+    }
+  }
+
+  std::string m_path;
+  std::FILE* m_file = nullptr;
+  std::vector<T> m_front;
+  std::vector<T> m_back;
+  std::future<bool> m_pending;
+  std::size_t m_size = 0;
+};
+
+// A tournament over k sources that finds the next element of a k-way
+// merge in log k comparisons. Each internal node keeps the loser of
+// the match played there, node 0 the overall winner, so when the
+// winner's source moves on only the matches on its own path to the
+// root are replayed
+//
+// "beats (a, b)" says whether source a's head comes before source b's
+//
+template<typename Beats>
+class LoserTree
+{
+public:
+  LoserTree (std::size_t k, Beats beats)
+    : m_k (k),
+      m_tree (k),
+      m_beats (std::move (beats))
+  {
+    m_tree[0] = play (1);
+  }
+
+  std::size_t
+  winner () const
+  {
+    return m_tree[0];
+  }
+
+  // the winner's head has changed: find the new winner
+  void
+  replay ()
+  {
+    std::size_t winner = m_tree[0];
+    for (std::size_t node = (winner + m_k) / 2; node > 0; node /= 2)
+    {
+      // written to compile to conditional moves: which side wins is
+      // as good as random
+      std::size_t const other = m_tree[node];
+      bool const lost = m_beats (other, winner);
+      m_tree[node] = lost ? winner : other;
+      winner = lost ? other : winner;
+    }
+    m_tree[0] = winner;
+  }
+
+private:
+  // leaves are nodes k to 2k - 1, one per source
+  std::size_t
+  play (std::size_t node)
+  {
+    if (node >= m_k)
+    {
+      return node - m_k;
+    }
+    std::size_t a = play (2 * node);
+    std::size_t b = play (2 * node + 1);
+    if (m_beats (b, a))
+    {
+      std::swap (a, b);
+    }
+    m_tree[node] = b;
+    return a;
+  }
+
+  std::size_t m_k;
+  std::vector<std::size_t> m_tree;
+  Beats m_beats;
+};
+
+// Merge the sorted run files "runs" into "sink"
+//
+template<typename T, typename Sink, typename Compare, typename Proj>
+void
+merge_runs (std::vector<std::string> const& runs, Sink& sink,
+            std::size_t blockElements, Compare comp, Proj proj)
+{
+  std::vector<std::unique_ptr<BlockReader<T>>> readers;
+  for (std::string const& run : runs)
+  {
+    readers.push_back (std::make_unique<BlockReader<T>> (run, blockElements));
+  }
+  // each run's head, or null once it is used up
+  std::vector<T const*> heads;
+  for (auto const& reader : readers)
+  {
+    heads.push_back (reader->empty () ? nullptr : &reader->front ());
+  }
+  auto const beats = [&] (std::size_t a, std::size_t b) {
+    return heads[a] != nullptr
+           && (heads[b] == nullptr
+               || comp (std::invoke (proj, *heads[a]),
+                        std::invoke (proj, *heads[b])));
+  };
+  LoserTree<decltype (beats)> tree (readers.size (), beats);
+  for (std::size_t w = tree.winner (); heads[w] != nullptr; w = tree.winner ())
+  {
+    sink.put (*heads[w]);
+    readers[w]->pop ();
+    heads[w] = readers[w]->empty () ? nullptr : &readers[w]->front ();
+    tree.replay ();
+  }
+}
+
+// The sort itself, between a Source -- read (buf, n) fills buf with up
+// to n elements and returns how many, 0 at the end -- and a Sink --
+// put (x) for each element in order, then close ()
+//
+template<typename T, typename Source, typename Sink, typename Compare,
+         typename Proj>
+ExternalSortStats
+spill_and_merge (Source& source, Sink& sink, ExternalSortOptions const& options,
+               Compare comp, Proj proj)
+{
+  static_assert (std::is_trivially_copyable_v<T>,
+                 "external_sort writes elements to disk byte for byte");
+
+  std::size_t const runElements =
+    options.memoryBytes / sizeof (T) > 0 ? options.memoryBytes / sizeof (T) : 1;
+  std::size_t const blockElements =
+    options.blockBytes / sizeof (T) > 0 ? options.blockBytes / sizeof (T) : 1;
+  // each run being merged has two blocks in memory, and so does the output
+  std::size_t const budget = options.memoryBytes / (2 * options.blockBytes);
+  std::size_t const fanIn = budget > 3 ? budget - 1 : 2;
+
+  ExternalSortStats stats;
+  std::vector<std::unique_ptr<TempFile>> runs;
+  {
+    std::vector<T> run (runElements);
+    bool done = false;
+    while (!done)
+    {
+      std::size_t n = 0;
+      while (n < runElements)
+      {
+        std::size_t const got = source.read (run.data () + n, runElements - n);
+        if (got == 0)
+        {
+          done = true;
+          break;
+        }
+        n += got;
+      }
+      if (n == 0)
+      {
+        break;
+      }
+      stats.elements += n;
+      ++stats.runs;
+      SortUtils::quick_sort (run.begin (), run.begin () + n, comp, proj);
+
+      if (done && runs.empty ())
+      {
+        // it all fit: no need to touch the disk
+        for (std::size_t i = 0; i < n; ++i)
+        {
+          sink.put (run[i]);
+        }
+        sink.close ();
+        return stats;
+      }
+      runs.push_back (std::make_unique<TempFile> (options.tempDirectory));
+      std::FILE* file = open_binary (runs.back ()->path (), "wb");
+      bool const written = std::fwrite (run.data (), sizeof (T), n, file) == n;
+      if (std::fclose (file) != 0 || !written)
+      {
+        throw std::runtime_error ("external_sort: cannot write "
+                                  + runs.back ()->path ());
+      }
+    }
+  }
+
+  // merge groups of runs into longer ones until one merge can finish
+  while (runs.size () > fanIn)
+  {
+    std::vector<std::unique_ptr<TempFile>> merged;
+    for (std::size_t lo = 0; lo < runs.size (); lo += fanIn)
+    {
+      std::size_t const hi = lo + fanIn < runs.size () ? lo + fanIn : runs.size ();
+      std::vector<std::string> group;
+      for (std::size_t i = lo; i < hi; ++i)
+      {
+        group.push_back (runs[i]->path ());
+      }
+      merged.push_back (std::make_unique<TempFile> (options.tempDirectory));
+      BlockWriter<T> writer (merged.back ()->path (), blockElements);
+      SortUtils::merge_runs<T> (group, writer, blockElements, comp, proj);
+      writer.close ();
+    }
+    runs = std::move (merged);
+    ++stats.mergePasses;
+  }
+
+  std::vector<std::string> paths;
+  for (auto const& run : runs)
+  {
+    paths.push_back (run->path ());
+  }
+  if (!paths.empty ())
+  {
+    SortUtils::merge_runs<T> (paths, sink, blockElements, comp, proj);
+    ++stats.mergePasses;
+  }
+  sink.close ();
+  return stats;
+}
+
+// Sort the binary file of T at "input" into "output", which may be
+// the same file
+//
+template<typename T, typename Compare = std::less<>, typename Proj = identity>
+ExternalSortStats
+external_sort (std::string const& input, std::string const& output,
+               ExternalSortOptions const& options = {}, Compare comp = {},
+               Proj proj = {})
+{
+  struct FileSource
+  {
+    std::FILE* file;
+
+    std::size_t
+    read (T* buf, std::size_t n)
+    {
+      std::size_t const got = std::fread (buf, sizeof (T), n, file);
+      if (got < n && std::ferror (file))
+      {
+        throw std::runtime_error ("external_sort: read failed");
+      }
+      return got;
+    }
+  };
+
+  std::FILE* file = open_binary (input, "rb");
+  FileSource source{file};
+  try
+  {
+    BlockWriter<T> sink (output, options.blockBytes / sizeof (T) > 0
+                                   ? options.blockBytes / sizeof (T)
+                                   : 1);
+    ExternalSortStats stats =
+      SortUtils::spill_and_merge<T> (source, sink, options, comp, proj);
+    std::fclose (file);
+    return stats;
+  }
+  catch (...)
+  {
+    std::fclose (file);
+    throw;
+  }
+}
+
+// Sort the InputRange [first, last) into the OutputIterator "out"
+//
+template<typename InIter, typename OutIter, typename Compare = std::less<>,
+         typename Proj = identity>
+ExternalSortStats
+external_sort (InIter first, InIter last, OutIter out,
+               ExternalSortOptions const& options = {}, Compare comp = {},
+               Proj proj = {})
+{
+  using T = typename std::iterator_traits<InIter>::value_type;
+
+  struct IterSource
+  {
+    InIter first;
+    InIter last;
+
+    std::size_t
+    read (T* buf, std::size_t n)
+    {
+      std::size_t got = 0;
+      for (; got < n && first != last; ++first)
+      {
+        buf[got++] = *first;
+      }
+      return got;
+    }
+  };
+
+  struct IterSink
+  {
+    OutIter out;
+
+    void
+    put (T const& value)
+    {
+      *out = value;
+      ++out;
+    }
+
+    void
+    close ()
+    {
+    }
+  };
+
+  IterSource source{first, last};
+  IterSink sink{out};
+  return SortUtils::spill_and_merge<T> (source, sink, options, comp, proj);
+}
+
+} // end namespace SortUtils
+
+#endif
@@ -0,0 +1,85 @@
+// Scaling benchmark for the parallel sorts
+//
+// usage: ParallelBench [N [maxThreads]]
+//
+// Sorts N random ints (default 20M) with merge_sort and quick_sort,
+// then with their parallel versions on 1, 2, 4, ... threads up to
+// maxThreads (default: every hardware thread), and prints the time of
+// each and its speedup over the sequential sort
+
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "DivideAndConquer.hpp"
+#include "ParallelSort.hpp"
+
+template<typename Sort>
+double
+time_sort (std::vector<int> const& input, Sort sort)
+{
+  std::vector<int> v (input);
+  auto const start = std::chrono::steady_clock::now ();
+  sort (v);
+  std::chrono::duration<double> const elapsed =
+    std::chrono::steady_clock::now () - start;
+  for (std::size_t i = 1; i < v.size (); ++i)
+  {
+    if (v[i] < v[i - 1])
+    {
+      std::cerr << "not sorted!\n";
+      std::exit (EXIT_FAILURE);
+    }
+  }
+  return elapsed.count ();
+}
+
+int
+main (int argc, char* argv[])
+{
+  std::size_t const n = argc > 1 ? std::stoul (argv[1]) : 20000000;
+  unsigned const hardware = std::thread::hardware_concurrency ();
+  unsigned const maxThreads =
+    argc > 2 ? std::stoul (argv[2]) : (hardware == 0 ? 1 : hardware);
+
+  std::vector<int> input (n);
+  std::mt19937 rng{2047};
+  for (int& x : input)
+  {
+    x = static_cast<int> (rng ());
+  }
+
+  double const mergeTime = time_sort (input, [] (std::vector<int>& v) {
+    SortUtils::merge_sort (v.begin (), v.end ());
+  });
+  double const quickTime = time_sort (input, [] (std::vector<int>& v) {
+    SortUtils::quick_sort (v.begin (), v.end ());
+  });
+
+  std::cout << n << " ints, " << hardware << " hardware threads\n\n"
+            << std::fixed << std::setprecision (3)
+            << "threads    merge (s)  speedup    quick (s)  speedup\n"
+            << "sequential " << std::setw (9) << mergeTime << "  "
+            << std::setw (7) << 1.0 << "  " << std::setw (11) << quickTime
+            << "  " << std::setw (7) << 1.0 << '\n';
+
+  for (unsigned threads = 1; threads <= maxThreads; threads *= 2)
+  {
+    SortUtils::WorkStealingPool pool (threads);
+    double const merge = time_sort (input, [&] (std::vector<int>& v) {
+      SortUtils::parallel_merge_sort (v.begin (), v.end (), pool);
+    });
+    double const quick = time_sort (input, [&] (std::vector<int>& v) {
+      SortUtils::parallel_quick_sort (v.begin (), v.end (), pool);
+    });
+    std::cout << std::setw (10) << threads << ' ' << std::setw (9) << merge
+              << "  " << std::setw (7) << mergeTime / merge << "  "
+              << std::setw (11) << quick << "  " << std::setw (7)
+              << quickTime / quick << '\n';
+  }
+}
@@ -0,0 +1,301 @@
+#ifndef PARALLEL_SORT_HPP_
+#define PARALLEL_SORT_HPP_
+
+#include <cstddef>
+#include <iterator>
+#include <utility>
+#include <vector>
+
+#include "DivideAndConquer.hpp"
+#include "WorkStealingPool.hpp"
+
+namespace SortUtils
+{
+
+// Ranges this small are sorted (or merged, or partitioned) by one task
+constexpr std::ptrdiff_t PARALLEL_GRAIN = 1 << 14;
+
+// Given sorted ranges a[0, m) and b[0, n), return how many elements
+// of "a" are among the first "k" elements of their merge. Ties go to
+// "a", as in merge. O(log (m + n))
+//
+template<typename Iter1, typename Iter2>
+std::ptrdiff_t
+co_rank (std::ptrdiff_t k, Iter1 a, std::ptrdiff_t m, Iter2 b, std::ptrdiff_t n)
+{
+  std::ptrdiff_t lo = k > n ? k - n : 0;
+  std::ptrdiff_t hi = k < m ? k : m;
+  while (true)
+  {
+    std::ptrdiff_t const i = lo + (hi - lo) / 2;
+    std::ptrdiff_t const j = k - i;
+    if (i > 0 && j < n && b[j] < a[i - 1])
+    {
+      // a[i - 1] comes after b[j]: too many from "a"
+      hi = i - 1;
+    }
+    else if (j > 0 && i < m && !(b[j - 1] < a[i]))
+    {
+      // a[i] comes before b[j - 1]: too few from "a"
+      lo = i + 1;
+    }
+    else
+    {
+      return i;
+    }
+  }
+}
+
+// Merge sorted ranges a[0, m) and b[0, n) into "out" in parallel: the
+// output is cut into pieces of "grain" elements, and co_rank finds
+// where each piece's inputs start, so every piece merges on its own
+//
+// Every split is found before any piece starts: the inputs may be
+// move_iterators, and a search running beside a merge would compare
+// elements that merge has already moved from
+//
+template<typename Iter1, typename Iter2, typename OIter>
+void
+parallel_merge (Iter1 a, std::ptrdiff_t m, Iter2 b, std::ptrdiff_t n,
+                OIter out, WorkStealingPool& pool,
+                std::ptrdiff_t grain = PARALLEL_GRAIN)
+{
+  std::ptrdiff_t const pieces = (m + n + grain - 1) / grain;
+  // splits[p]: how many of "a" the first p pieces take
+  std::vector<std::ptrdiff_t> splits (pieces + 1);
+  for (std::ptrdiff_t p = 0; p <= pieces; ++p)
+  {
+    std::ptrdiff_t const k = p * grain < m + n ? p * grain : m + n;
+    splits[p] = SortUtils::co_rank (k, a, m, b, n);
+  }
+
+  TaskGroup group (pool);
+  for (std::ptrdiff_t p = 0; p < pieces; ++p)
+  {
+    std::ptrdiff_t const k0 = p * grain;
+    std::ptrdiff_t const k1 = k0 + grain < m + n ? k0 + grain : m + n;
+    std::ptrdiff_t const i0 = splits[p];
+    std::ptrdiff_t const i1 = splits[p + 1];
+    group.run ([=] {
+      SortUtils::merge (a + i0, a + i1, b + (k0 - i0), b + (k1 - i1), out + k0);
+    });
+  }
+  group.wait ();
+}
+
+// Sort src[0, n), leaving the result in src or, if "toBuffer", in
+// buf[0, n). The halves are sorted into the other array, so each
+// level merges straight into its destination with no copying back
+//
+template<typename Iter, typename BufIter>
+void
+parallel_merge_sort_into (Iter src, BufIter buf, std::ptrdiff_t n,
+                          bool toBuffer, WorkStealingPool& pool,
+                          std::ptrdiff_t grain)
+{
+  if (n <= grain)
+  {
+    SortUtils::merge_sort (src, src + n, buf);
+    if (toBuffer)
+    {
+      std::copy (std::make_move_iterator (src),
+                 std::make_move_iterator (src + n), buf);
+    }
+    return;
+  }
+  std::ptrdiff_t const mid = n / 2;
+  {
+    TaskGroup group (pool);
+    group.run ([=, &pool] {
+      SortUtils::parallel_merge_sort_into (src, buf, mid, !toBuffer, pool, grain);
+    });
+    SortUtils::parallel_merge_sort_into (src + mid, buf + mid, n - mid,
+                                         !toBuffer, pool, grain);
+    group.wait ();
+  }
+  if (toBuffer)
+  {
+    SortUtils::parallel_merge (std::make_move_iterator (src), mid,
+                               std::make_move_iterator (src + mid), n - mid,
+                               buf, pool, grain);
+  }
+  else
+  {
+    SortUtils::parallel_merge (std::make_move_iterator (buf), mid,
+                               std::make_move_iterator (buf + mid), n - mid,
+                               src, pool, grain);
+  }
+}
+
+// Given a RandomAccessRange, sort using merge sort on "pool". Stable,
+// and allocates one buffer for the whole sort
+//
+template<typename Iter>
+void
+parallel_merge_sort (Iter first, Iter last, WorkStealingPool& pool,
+                     std::ptrdiff_t grain = PARALLEL_GRAIN)
+{
+  using T = std::remove_reference_t<decltype (*std::declval<Iter> ())>;
+
+  std::ptrdiff_t const n = std::distance (first, last);
+  if (n < 2)
+  {
+    return;
+  }
+  std::vector<T> buf (first, last);
+  SortUtils::parallel_merge_sort_into (first, buf.begin (), n, false, pool,
+                                       grain < 1 ? 1 : grain);
+}
+
+// Three-way partition of first[0, n) around "pivot" in parallel: each
+// block is partitioned on its own, then every block's three groups
+// are moved to their final offsets in "buf" and the whole range is
+// moved back. Returns the same pair of iterators as partition
+//
+template<typename Iter, typename BufIter, typename Value>
+std::pair<Iter, Iter>
+parallel_partition (Iter first, BufIter buf, std::ptrdiff_t n,
+                    Value const& pivot, WorkStealingPool& pool,
+                    std::ptrdiff_t grain = PARALLEL_GRAIN)
+{
+  std::ptrdiff_t const blocks = (n + grain - 1) / grain;
+  // per block: [begin, end of < group, end of == group, end)
+  std::vector<std::ptrdiff_t> bounds (4 * blocks);
+  {
+    TaskGroup group (pool);
+    for (std::ptrdiff_t b = 0; b < blocks; ++b)
+    {
+      group.run ([=, &bounds] {
+        std::ptrdiff_t const lo = b * grain;
+        std::ptrdiff_t const hi = lo + grain < n ? lo + grain : n;
+        auto [p1, p2] = SortUtils::fast_partition (first + lo, first + hi, pivot);
+        bounds[4 * b] = lo;
+        bounds[4 * b + 1] = p1 - first;
+        bounds[4 * b + 2] = p2 - first;
+        bounds[4 * b + 3] = hi;
+      });
+    }
+    group.wait ();
+  }
+
+  // where each block's groups go: the < groups first, block by block,
+  // then the == groups, then the > groups
+  std::vector<std::ptrdiff_t> offsets (3 * blocks);
+  std::ptrdiff_t total[3] = {0, 0, 0};
+  for (std::ptrdiff_t b = 0; b < blocks; ++b)
+  {
+    for (int g = 0; g < 3; ++g)
+    {
+      offsets[3 * b + g] = total[g];
+      total[g] += bounds[4 * b + g + 1] - bounds[4 * b + g];
+    }
+  }
+  std::ptrdiff_t const base[3] = {0, total[0], total[0] + total[1]};
+
+  {
+    TaskGroup group (pool);
+    for (std::ptrdiff_t b = 0; b < blocks; ++b)
+    {
+      group.run ([=, &bounds, &offsets] {
+        for (int g = 0; g < 3; ++g)
+        {
+          std::copy (std::make_move_iterator (first + bounds[4 * b + g]),
+                     std::make_move_iterator (first + bounds[4 * b + g + 1]),
+                     buf + base[g] + offsets[3 * b + g]);
+        }
+      });
+    }
+    group.wait ();
+  }
+  {
+    TaskGroup group (pool);
+    for (std::ptrdiff_t lo = 0; lo < n; lo += grain)
+    {
+      std::ptrdiff_t const hi = lo + grain < n ? lo + grain : n;
+      group.run ([=] {
+        std::copy (std::make_move_iterator (buf + lo),
+                   std::make_move_iterator (buf + hi), first + lo);
+      });
+    }
+    group.wait ();
+  }
+  return {first + base[1], first + base[2]};
+}
+
+// parallel_quick_sort's loop, the parallel twin of introsort_loop:
+// spawn the smaller side as a task and keep the larger one. Ranges
+// under "grain" are sorted sequentially, and once "depth" runs out the
+// range is merge sorted instead, in parallel
+//
+template<typename Iter, typename BufIter>
+void
+parallel_quick_sort_loop (Iter first, BufIter buf, std::ptrdiff_t n,
+                          int depth, WorkStealingPool& pool,
+                          std::ptrdiff_t grain)
+{
+  TaskGroup group (pool);
+  while (n > grain)
+  {
+    if (depth == 0)
+    {
+      SortUtils::parallel_merge_sort_into (first, buf, n, false, pool, grain);
+      n = 0;
+      break;
+    }
+    --depth;
+    auto const pivot = *SortUtils::median3 (first, first + n);
+    // partitioning a range only a few grains long isn't worth the
+    // extra pass through the buffer
+    auto [p1, p2] =
+      n >= 4 * grain
+        ? SortUtils::parallel_partition (first, buf, n, pivot, pool, grain)
+        : SortUtils::fast_partition (first, first + n, pivot);
+    std::ptrdiff_t const left = p1 - first;
+    std::ptrdiff_t const right = first + n - p2;
+    std::ptrdiff_t const offset = p2 - first;
+    if (left < right)
+    {
+      group.run ([=, &pool] {
+        SortUtils::parallel_quick_sort_loop (first, buf, left, depth, pool, grain);
+      });
+      first += offset;
+      buf += offset;
+      n = right;
+    }
+    else
+    {
+      group.run ([=, &pool] {
+        SortUtils::parallel_quick_sort_loop (first + offset, buf + offset, right,
+                                             depth, pool, grain);
+      });
+      n = left;
+    }
+  }
+  SortUtils::quick_sort (first, first + n);
+  group.wait ();
+}
+
+// Given a RandomAccessRange, sort using quick sort on "pool"
+//
+template<typename Iter>
+void
+parallel_quick_sort (Iter first, Iter last, WorkStealingPool& pool,
+                     std::ptrdiff_t grain = PARALLEL_GRAIN)
+{
+  using T = std::remove_reference_t<decltype (*std::declval<Iter> ())>;
+
+  std::ptrdiff_t const n = std::distance (first, last);
+  if (n < 2)
+  {
+    return;
+  }
+  // scratch space for parallel_partition and the merge sort fallback
+  std::vector<T> buf (first, last);
+  SortUtils::parallel_quick_sort_loop (first, buf.begin (), n,
+                                       2 * SortUtils::log2_floor (n), pool,
+                                       grain < 1 ? 1 : grain);
+}
+
+} // end namespace SortUtils
+
+#endif
@@ -0,0 +1,374 @@
+#ifndef PARTITION_SIMD_HPP_
+#define PARTITION_SIMD_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+#include "../common/SimdIsa.hpp"
+
+// Vectorized two-way partition of a contiguous array of numbers
+//
+// partition (a, n, pivot, orEqual) moves every x with x < pivot (or,
+// if "orEqual", every x with !(x > pivot)) to the front of a[0, n) and
+// returns how many there are. The order within each side is not kept
+//
+// The loop works in place, Bramas-style: the first and last vector of
+// the array are set aside, which leaves a vector's worth of free space
+// at each end. Each step reads the next vector from whichever end has
+// less free space, so both ends always have room, and writes its
+// "left" lanes at the front and its "right" lanes at the back
+//
+// AVX-512 covers 32- and 64-bit integers, float and double; AVX2
+// covers the 32-bit types. The instruction set is picked at run time
+
+namespace SortUtils
+{
+namespace PartitionSimd
+{
+
+// Arrays shorter than this are left to the scalar loop
+constexpr std::size_t MIN_SIZE = 64;
+
+template<typename T>
+constexpr bool is_32bit =
+  std::is_same_v<T, std::int32_t> || std::is_same_v<T, std::uint32_t>
+  || std::is_same_v<T, float>;
+
+template<typename T>
+constexpr bool is_64bit =
+  std::is_same_v<T, std::int64_t> || std::is_same_v<T, std::uint64_t>
+  || std::is_same_v<T, double>;
+
+// Types that have a vector kernel on some CPU
+template<typename T>
+constexpr bool has_kernel = SIMD_ISA_X86 && (is_32bit<T> || is_64bit<T>);
+
+template<typename T>
+bool
+goes_left (T x, T pivot, bool orEqual)
+{
+  return orEqual ? !(x > pivot) : x < pivot;
+}
+
+// Scalar version, also used to finish the vector loops
+template<typename T>
+std::size_t
+partition_scalar (T* a, std::size_t n, T pivot, bool orEqual)
+{
+  std::size_t left = 0;
+  for (std::size_t i = 0; i < n; ++i)
+  {
+    if (goes_left (a[i], pivot, orEqual))
+    {
+      T const x = a[i];
+      a[i] = a[left];
+      a[left++] = x;
+    }
+  }
+  return left;
+}
+
+// Place the "count" values in rest[] into the gap a[left, right),
+// "left" ones at the front. Returns the new "left"
+template<typename T>
+std::size_t
+place_rest (T* a, std::size_t left, std::size_t right, T const* rest,
+            std::size_t count, T pivot, bool orEqual)
+{
+  for (std::size_t i = 0; i < count; ++i)
+  {
+    if (goes_left (rest[i], pivot, orEqual))
+    {
+      a[left++] = rest[i];
+    }
+    else
+    {
+      a[--right] = rest[i];
+    }
+  }
+  return left;
+}
+
+// The instruction set selection is shared with the other modules
+using SimdIsa::Isa;
+using SimdIsa::detect_isa;
+using SimdIsa::active_isa;
+using SimdIsa::set_isa;
+
+#if SIMD_ISA_X86
+
+/************************************************************/
+// AVX2, 8 lanes of 32 bits
+
+#define PARTITION_AVX2 __attribute__ ((target ("avx2")))
+
+// For each 8-bit mask, the lane order that puts the set lanes first
+// and the clear lanes last, one index per byte
+struct PermutationTable
+{
+  constexpr PermutationTable ()
+    : order ()
+  {
+    for (unsigned mask = 0; mask < 256; ++mask)
+    {
+      unsigned k = 0;
+      for (unsigned pass = 0; pass < 2; ++pass)
+      {
+        for (unsigned lane = 0; lane < 8; ++lane)
+        {
+          if (((mask >> lane) & 1) != pass)
+          {
+            order[mask] |= std::uint64_t (lane) << (8 * k++);
+          }
+        }
+      }
+    }
+  }
+
+  std::uint64_t order[256];
+};
+
+inline constexpr PermutationTable permutation_table{};
+
+// Bit i is set if lane i of "v" goes left. Unsigned lanes are
+// compared as signed after flipping their top bits
+template<typename T>
+PARTITION_AVX2 inline unsigned
+left_mask_avx2 (__m256i v, __m256i p, bool orEqual)
+{
+  if constexpr (std::is_same_v<T, float>)
+  {
+    __m256 const x = _mm256_castsi256_ps (v);
+    __m256 const y = _mm256_castsi256_ps (p);
+    return _mm256_movemask_ps (orEqual ? _mm256_cmp_ps (x, y, _CMP_NGT_UQ)
+                                       : _mm256_cmp_ps (x, y, _CMP_LT_OQ));
+  }
+  else
+  {
+    if constexpr (std::is_same_v<T, std::uint32_t>)
+    {
+      __m256i const top = _mm256_set1_epi32 (INT32_MIN);
+      v = _mm256_xor_si256 (v, top);
+      p = _mm256_xor_si256 (p, top);
+    }
+    if (orEqual)
+      return ~_mm256_movemask_ps (_mm256_castsi256_ps (_mm256_cmpgt_epi32 (v, p))) & 0xFF;
+    return _mm256_movemask_ps (_mm256_castsi256_ps (_mm256_cmpgt_epi32 (p, v)));
+  }
+}
+
+template<typename T>
+PARTITION_AVX2 inline __m256i
+load_avx2 (T const* q)
+{
+  return _mm256_loadu_si256 (reinterpret_cast<__m256i const*> (q));
+}
+
+template<typename T>
+PARTITION_AVX2 inline void
+store_avx2 (T* q, __m256i v)
+{
+  _mm256_storeu_si256 (reinterpret_cast<__m256i*> (q), v);
+}
+
+template<typename T>
+PARTITION_AVX2 std::size_t
+partition_avx2 (T* a, std::size_t n, T pivot, bool orEqual)
+{
+  constexpr std::size_t S = 8;
+  if (n < MIN_SIZE)
+    return partition_scalar (a, n, pivot, orEqual);
+
+  __m256i p;
+  if constexpr (std::is_same_v<T, float>)
+    p = _mm256_castps_si256 (_mm256_set1_ps (pivot));
+  else
+    p = _mm256_set1_epi32 (static_cast<int> (pivot));
+  __m256i const first = load_avx2 (a);
+  __m256i const last = load_avx2 (a + n - S);
+  std::size_t left = 0, right = n, readLeft = S, readRight = n - S;
+  while (readRight - readLeft >= S)
+  {
+    __m256i v;
+    if (readLeft - left <= right - readRight)
+    {
+      v = load_avx2 (a + readLeft);
+      readLeft += S;
+    }
+    else
+    {
+      readRight -= S;
+      v = load_avx2 (a + readRight);
+    }
+    unsigned const mask = left_mask_avx2<T> (v, p, orEqual);
+    __m256i const order = _mm256_cvtepu8_epi32 (
+      _mm_cvtsi64_si128 (permutation_table.order[mask]));
+    // left lanes first, right lanes last: store the whole vector at
+    // both ends, each end keeps its own lanes
+    __m256i const w = _mm256_permutevar8x32_epi32 (v, order);
+    std::size_t const count = __builtin_popcount (mask);
+    store_avx2 (a + left, w);
+    store_avx2 (a + right - S, w);
+    left += count;
+    right -= S - count;
+  }
+
+  T rest[3 * S];
+  std::size_t count = 0;
+  for (std::size_t i = readLeft; i < readRight; ++i)
+    rest[count++] = a[i];
+  store_avx2 (rest + count, first);
+  store_avx2 (rest + count + S, last);
+  return place_rest (a, left, right, rest, count + 2 * S, pivot, orEqual);
+}
+
+#undef PARTITION_AVX2
+
+/************************************************************/
+// AVX-512, 16 lanes of 32 bits or 8 of 64; compress stores write
+// only the lanes they keep
+
+SIMD_ISA_AVX512_BEGIN
+
+#define PARTITION_AVX512 __attribute__ ((target ("avx512f")))
+
+template<typename T>
+PARTITION_AVX512 inline __m512i
+broadcast_avx512 (T pivot)
+{
+  if constexpr (std::is_same_v<T, float>)
+    return _mm512_castps_si512 (_mm512_set1_ps (pivot));
+  else if constexpr (std::is_same_v<T, double>)
+    return _mm512_castpd_si512 (_mm512_set1_pd (pivot));
+  else if constexpr (is_32bit<T>)
+    return _mm512_set1_epi32 (static_cast<int> (pivot));
+  else
+    return _mm512_set1_epi64 (static_cast<long long> (pivot));
+}
+
+// Bit i is set if lane i of "v" goes left
+template<typename T>
+PARTITION_AVX512 inline unsigned
+left_mask_avx512 (__m512i v, __m512i p, bool orEqual)
+{
+  if constexpr (std::is_same_v<T, float>)
+    return orEqual ? _mm512_cmp_ps_mask (_mm512_castsi512_ps (v), _mm512_castsi512_ps (p), _CMP_NGT_UQ)
+                   : _mm512_cmp_ps_mask (_mm512_castsi512_ps (v), _mm512_castsi512_ps (p), _CMP_LT_OQ);
+  else if constexpr (std::is_same_v<T, double>)
+    return orEqual ? _mm512_cmp_pd_mask (_mm512_castsi512_pd (v), _mm512_castsi512_pd (p), _CMP_NGT_UQ)
+                   : _mm512_cmp_pd_mask (_mm512_castsi512_pd (v), _mm512_castsi512_pd (p), _CMP_LT_OQ);
+  else if constexpr (std::is_same_v<T, std::int32_t>)
+    return orEqual ? _mm512_cmple_epi32_mask (v, p) : _mm512_cmplt_epi32_mask (v, p);
+  else if constexpr (std::is_same_v<T, std::uint32_t>)
+    return orEqual ? _mm512_cmple_epu32_mask (v, p) : _mm512_cmplt_epu32_mask (v, p);
+  else if constexpr (std::is_same_v<T, std::int64_t>)
+    return orEqual ? _mm512_cmple_epi64_mask (v, p) : _mm512_cmplt_epi64_mask (v, p);
+  else
+    return orEqual ? _mm512_cmple_epu64_mask (v, p) : _mm512_cmplt_epu64_mask (v, p);
+}
+
+// Write the lanes of "v" selected by "mask" to q[0, popcount (mask))
+template<typename T>
+PARTITION_AVX512 inline void
+compress_avx512 (T* q, unsigned mask, __m512i v)
+{
+  if constexpr (is_32bit<T>)
+    _mm512_mask_compressstoreu_epi32 (q, static_cast<__mmask16> (mask), v);
+  else
+    _mm512_mask_compressstoreu_epi64 (q, static_cast<__mmask8> (mask), v);
+}
+
+template<typename T>
+PARTITION_AVX512 std::size_t
+partition_avx512 (T* a, std::size_t n, T pivot, bool orEqual)
+{
+  constexpr std::size_t S = 64 / sizeof (T);
+  constexpr unsigned all = (1u << S) - 1;
+  if (n < MIN_SIZE)
+    return partition_scalar (a, n, pivot, orEqual);
+
+  __m512i const p = broadcast_avx512 (pivot);
+  __m512i const first = _mm512_loadu_si512 (a);
+  __m512i const last = _mm512_loadu_si512 (a + n - S);
+  std::size_t left = 0, right = n, readLeft = S, readRight = n - S;
+  while (readRight - readLeft >= S)
+  {
+    __m512i v;
+    if (readLeft - left <= right - readRight)
+    {
+      v = _mm512_loadu_si512 (a + readLeft);
+      readLeft += S;
+    }
+    else
+    {
+      readRight -= S;
+      v = _mm512_loadu_si512 (a + readRight);
+    }
+    unsigned const mask = left_mask_avx512<T> (v, p, orEqual);
+    std::size_t const count = __builtin_popcount (mask);
+    compress_avx512 (a + left, mask, v);
+    left += count;
+    right -= S - count;
+    compress_avx512 (a + right, ~mask & all, v);
+  }
+
+  T rest[3 * S];
+  std::size_t count = 0;
+  for (std::size_t i = readLeft; i < readRight; ++i)
+    rest[count++] = a[i];
+  _mm512_storeu_si512 (rest + count, first);
+  _mm512_storeu_si512 (rest + count + S, last);
+  return place_rest (a, left, right, rest, count + 2 * S, pivot, orEqual);
+}
+
+#undef PARTITION_AVX512
+SIMD_ISA_AVX512_END
+
+#endif
+
+/************************************************************/
+
+// Whether this CPU has a vector kernel for T
+template<typename T>
+bool
+available ()
+{
+#if SIMD_ISA_X86
+  if constexpr (has_kernel<T>)
+  {
+    Isa const isa = active_isa ();
+    return isa == Isa::Avx512 || (isa == Isa::Avx2 && is_32bit<T>);
+  }
+#endif
+  return false;
+}
+
+// Partition with the best kernel for this CPU
+template<typename T>
+std::size_t
+partition (T* a, std::size_t n, T pivot, bool orEqual)
+{
+#if SIMD_ISA_X86
+  if constexpr (has_kernel<T>)
+  {
+    switch (active_isa ())
+    {
+      case Isa::Avx512:
+        return partition_avx512 (a, n, pivot, orEqual);
+      case Isa::Avx2:
+        if constexpr (is_32bit<T>)
+          return partition_avx2 (a, n, pivot, orEqual);
+        break;
+      default:
+        break;
+    }
+  }
+#endif
+  return partition_scalar (a, n, pivot, orEqual);
+}
+
+} // end namespace PartitionSimd
+} // end namespace SortUtils
+
+#endif
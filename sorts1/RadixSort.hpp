@@ -0,0 +1,376 @@
+#ifndef RADIX_SORT_HPP_
+#define RADIX_SORT_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "DivideAndConquer.hpp"
+
+namespace SortUtils
+{
+
+// How the radix sorts see a value: as an unsigned Key whose order is
+// the value's order. Integers flip their sign bit; IEEE floats flip
+// every bit if negative and just the sign bit otherwise, so -0.0 sorts
+// before 0.0 and NaNs go to the ends (by sign)
+//
+template<typename T, typename = void>
+struct RadixTraits
+{
+  static constexpr bool supported = false;
+};
+
+template<typename T>
+struct RadixTraits<T, std::enable_if_t<std::is_integral_v<T>
+                                       && !std::is_same_v<T, bool>>>
+{
+  static constexpr bool supported = true;
+  using Key = std::make_unsigned_t<T>;
+
+  static Key
+  key (T x)
+  {
+    Key k = static_cast<Key> (x);
+    if constexpr (std::is_signed_v<T>)
+    {
+      k ^= Key (1) << (8 * sizeof (Key) - 1);
+    }
+    return k;
+  }
+};
+
+template<typename T>
+struct RadixTraits<T, std::enable_if_t<std::is_floating_point_v<T>
+                                       && std::numeric_limits<T>::is_iec559
+                                       && (sizeof (T) == 4 || sizeof (T) == 8)>>
+{
+  static constexpr bool supported = true;
+  using Key = std::conditional_t<sizeof (T) == 4, std::uint32_t, std::uint64_t>;
+
+  static Key
+  key (T x)
+  {
+    Key k;
+    std::memcpy (&k, &x, sizeof (k));
+    Key const sign = Key (1) << (8 * sizeof (Key) - 1);
+    return k ^ ((k & sign) ? ~Key (0) : sign);
+  }
+};
+
+// Radix sorts work on 8-bit digits
+constexpr int RADIX_BITS = 8;
+constexpr std::size_t RADIX = std::size_t (1) << RADIX_BITS;
+
+// Given a RandomAccessRange of integers or floats, sort using LSD
+// radix sort, with "buffer" (a RandomAccessIterator to at least N
+// assignable elements) as scratch space. Stable
+//
+// One pass counts every digit of every key; then each digit, least
+// significant first, is a counting-sort pass between the range and
+// the buffer. Digits every key shares are skipped, so small keys in a
+// wide type cost only the passes they need. O(N * sizeof (T))
+//
+template<typename Iter, typename BufIter>
+void
+lsd_radix_sort (Iter first, Iter last, BufIter buffer)
+{
+  using T = typename std::iterator_traits<Iter>::value_type;
+  using Traits = RadixTraits<T>;
+  static_assert (Traits::supported, "lsd_radix_sort sorts integers and floats");
+  using Key = typename Traits::Key;
+  constexpr int DIGITS = sizeof (Key);
+
+  const std::ptrdiff_t N = std::distance (first, last);
+  if (N < 2)
+  {
+    return;
+  }
+
+  std::size_t counts[DIGITS][RADIX] = {};
+  for (Iter i = first; i != last; ++i)
+  {
+    Key const k = Traits::key (*i);
+    for (int d = 0; d < DIGITS; ++d)
+    {
+      ++counts[d][(k >> (RADIX_BITS * d)) & (RADIX - 1)];
+    }
+  }
+
+  Key const firstKey = Traits::key (*first);
+  bool inBuffer = false;
+  for (int d = 0; d < DIGITS; ++d)
+  {
+    int const shift = RADIX_BITS * d;
+    if (counts[d][(firstKey >> shift) & (RADIX - 1)] == std::size_t (N))
+    {
+      continue;
+    }
+    // counts become each digit's first slot
+    std::size_t sum = 0;
+    for (std::size_t b = 0; b < RADIX; ++b)
+    {
+      std::size_t const count = counts[d][b];
+      counts[d][b] = sum;
+      sum += count;
+    }
+    auto const scatter = [&] (auto src, auto dst) {
+      for (std::ptrdiff_t i = 0; i < N; ++i)
+      {
+        std::size_t& slot = counts[d][(Traits::key (src[i]) >> shift) & (RADIX - 1)];
+        dst[slot++] = std::move (src[i]);
+      }
+    };
+    if (inBuffer)
+    {
+      scatter (buffer, first);
+    }
+    else
+    {
+      scatter (first, buffer);
+    }
+    inBuffer = !inBuffer;
+  }
+
+  if (inBuffer)
+  {
+    std::copy (std::make_move_iterator (buffer),
+               std::make_move_iterator (buffer + N), first);
+  }
+}
+
+// Given a RandomAccessRange of integers or floats, sort using LSD
+// radix sort. Allocates one buffer of N elements
+//
+template<typename Iter>
+void
+lsd_radix_sort (Iter first, Iter last)
+{
+  using T = typename std::iterator_traits<Iter>::value_type;
+
+  if (std::distance (first, last) < 2)
+  {
+    return;
+  }
+  std::vector<T> buf (first, last);
+  SortUtils::lsd_radix_sort (first, last, buf.begin ());
+}
+
+// Insertion sort by radix key, for msd_radix_sort's small buckets
+//
+template<typename Iter>
+void
+radix_insertion_sort (Iter first, Iter last)
+{
+  using T = typename std::iterator_traits<Iter>::value_type;
+  using Traits = RadixTraits<T>;
+
+  for (Iter i = first; i != last; ++i)
+  {
+    auto value = std::move (*i);
+    auto const k = Traits::key (value);
+    Iter j = i;
+    for (; j != first && Traits::key (*(j - 1)) > k; --j)
+    {
+      *j = std::move (*(j - 1));
+    }
+    *j = std::move (value);
+  }
+}
+
+// Buckets this small are left to radix_insertion_sort
+constexpr std::ptrdiff_t MSD_RADIX_THRESHOLD = 32;
+
+// msd_radix_sort's step: distribute [first, last) in place by the
+// digit at "shift", then sort each bucket by the next digit down
+//
+template<typename Iter>
+void
+msd_radix_sort (Iter first, Iter last, int shift)
+{
+  using T = typename std::iterator_traits<Iter>::value_type;
+  using Traits = RadixTraits<T>;
+
+  const std::ptrdiff_t N = std::distance (first, last);
+  if (N <= MSD_RADIX_THRESHOLD)
+  {
+    SortUtils::radix_insertion_sort (first, last);
+    return;
+  }
+  auto const digit = [shift] (T const& x) {
+    return (Traits::key (x) >> shift) & (RADIX - 1);
+  };
+
+  std::ptrdiff_t ends[RADIX] = {};
+  for (Iter i = first; i != last; ++i)
+  {
+    ++ends[digit (*i)];
+  }
+  std::ptrdiff_t heads[RADIX];
+  std::ptrdiff_t sum = 0;
+  for (std::size_t b = 0; b < RADIX; ++b)
+  {
+    heads[b] = sum;
+    sum += ends[b];
+    ends[b] = sum;
+  }
+
+  // American flag sort: take the first misplaced element of each
+  // bucket and swap it along the cycle of buckets it belongs to
+  for (std::size_t b = 0; b < RADIX; ++b)
+  {
+    while (heads[b] < ends[b])
+    {
+      auto value = std::move (first[heads[b]]);
+      for (std::size_t d = digit (value); d != b; d = digit (value))
+      {
+        std::swap (value, first[heads[d]++]);
+      }
+      first[heads[b]++] = std::move (value);
+    }
+  }
+
+  if (shift == 0)
+  {
+    return;
+  }
+  std::ptrdiff_t begin = 0;
+  for (std::size_t b = 0; b < RADIX; ++b)
+  {
+    if (ends[b] - begin > 1)
+    {
+      SortUtils::msd_radix_sort (first + begin, first + ends[b],
+                                 shift - RADIX_BITS);
+    }
+    begin = ends[b];
+  }
+}
+
+// Given a RandomAccessRange of integers or floats, sort using MSD
+// radix sort, in place. Not stable
+//
+// Each level splits the range into 256 buckets by one digit, most
+// significant first, then recurses into every bucket; the recursion
+// is at most sizeof (T) deep
+//
+template<typename Iter>
+void
+msd_radix_sort (Iter first, Iter last)
+{
+  using T = typename std::iterator_traits<Iter>::value_type;
+  static_assert (RadixTraits<T>::supported, "msd_radix_sort sorts integers and floats");
+
+  SortUtils::msd_radix_sort (first, last,
+                             RADIX_BITS * (sizeof (T) - 1));
+}
+
+// Given a RandomAccessRange of integers, sort using counting sort
+//
+// Counts each value between the smallest and the largest, then writes
+// the values back in order. O(N + max - min) time and O(max - min)
+// space, so only worth it when the values are close together.
+// Throws std::length_error if max - min does not fit in memory
+//
+template<typename Iter>
+void
+counting_sort (Iter first, Iter last)
+{
+  using T = typename std::iterator_traits<Iter>::value_type;
+  using Traits = RadixTraits<T>;
+  static_assert (Traits::supported && std::is_integral_v<T>,
+                 "counting_sort sorts integers");
+  using Key = typename Traits::Key;
+
+  if (std::distance (first, last) < 2)
+  {
+    return;
+  }
+  T min = *first;
+  Key lo = Traits::key (min);
+  Key hi = lo;
+  for (Iter i = first; i != last; ++i)
+  {
+    Key const k = Traits::key (*i);
+    if (k < lo)
+    {
+      min = *i;
+      lo = k;
+    }
+    hi = k > hi ? k : hi;
+  }
+  if (std::uintmax_t (hi - lo) >= std::vector<std::size_t> ().max_size ())
+  {
+    throw std::length_error ("counting_sort: range of values too large");
+  }
+
+  std::vector<std::size_t> counts (std::size_t (hi - lo) + 1);
+  for (Iter i = first; i != last; ++i)
+  {
+    ++counts[Traits::key (*i) - lo];
+  }
+  // the key of value "min + v" is "lo + v", so adding to the smallest
+  // value walks the values in order
+  Iter out = first;
+  for (std::size_t v = 0; v < counts.size (); ++v)
+  {
+    T const value = static_cast<T> (static_cast<Key> (min) + static_cast<Key> (v));
+    for (std::size_t c = counts[v]; c > 0; --c)
+    {
+      *out = value;
+      ++out;
+    }
+  }
+}
+
+// Ranges shorter than this are quick sorted by sort
+constexpr std::ptrdiff_t RADIX_SORT_THRESHOLD = 256;
+
+// Given a RandomAccessRange, sort it with whatever suits its values:
+// counting_sort for integers no further apart than there are
+// elements, lsd_radix_sort for other integers and floats, quick_sort
+// for everything else (and for short ranges)
+//
+template<typename Iter>
+void
+sort (Iter first, Iter last)
+{
+  using T = typename std::iterator_traits<Iter>::value_type;
+
+  const std::ptrdiff_t N = std::distance (first, last);
+  if constexpr (RadixTraits<T>::supported)
+  {
+    if (N >= RADIX_SORT_THRESHOLD)
+    {
+      if constexpr (std::is_integral_v<T>)
+      {
+        using Traits = RadixTraits<T>;
+        auto lo = Traits::key (*first);
+        auto hi = lo;
+        for (Iter i = first; i != last; ++i)
+        {
+          auto const k = Traits::key (*i);
+          lo = k < lo ? k : lo;
+          hi = k > hi ? k : hi;
+        }
+        if (std::uintmax_t (hi - lo) < std::uintmax_t (N))
+        {
+          SortUtils::counting_sort (first, last);
+          return;
+        }
+      }
+      SortUtils::lsd_radix_sort (first, last);
+      return;
+    }
+  }
+  SortUtils::quick_sort (first, last);
+}
+
+} // end namespace SortUtils
+
+#endif
@@ -0,0 +1,523 @@
+// Benchmark of the sequential sorts across sizes and input orders
+//
+// usage: SortBench [--counters] [--json FILE] [N ...]
+//
+// Sorts N ints (default 1000, 100000 and 1000000) in each of these
+// orders:
+//   random     uniform over every int
+//   sorted     already ascending
+//   reversed   descending
+//   few-unique 16 distinct values
+//   organ-pipe ascending to the middle, then descending
+//   zipf       Zipf (s = 1) over 1000 values: a few values are most of
+//              the data
+// with insertion_sort, merge_sort, tim_sort, quick_sort, heap_sort,
+// std::sort and std::stable_sort, and prints for each the best time
+// per element, and the comparisons and element moves per element.
+// insertion_sort is skipped above INSERTION_MAX elements
+//
+// Times are for plain ints with the default comparator, so they take
+// the same fast paths as real callers. Comparisons and moves come from
+// a separate, untimed run on a counting element type; a swap is three
+// moves
+//
+// --counters  also reads cycles, instructions and branch misses from
+//             perf_event (Linux; needs perf_event_paranoid <= 2)
+// --json FILE also writes every result to FILE, for tracking
+//             regressions between commits
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <string>
+#include <vector>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include "DivideAndConquer.hpp"
+#include "TimSort.hpp"
+
+// Larger inputs are not given to insertion_sort
+constexpr std::size_t INSERTION_MAX = 1 << 15;
+
+// Each input is sorted at least this many times and the best time kept;
+// small inputs are sorted until about TIME_BUDGET elements have been
+constexpr int MIN_REPS = 3;
+constexpr std::size_t TIME_BUDGET = 4000000;
+
+// Hardware counters read around each timed sort. Does nothing unless
+// enabled, or if the kernel will not open them
+//
+class PerfCounters
+{
+public:
+  static constexpr int COUNT = 3;
+  static constexpr char const* NAMES[COUNT] = { "cycles", "instructions",
+                                                "branch_misses" };
+  using Values = std::array<std::uint64_t, COUNT>;
+
+  explicit PerfCounters (bool enable)
+  {
+#ifdef __linux__
+    if (!enable)
+    {
+      return;
+    }
+    std::uint64_t const configs[COUNT] = { PERF_COUNT_HW_CPU_CYCLES,
+                                           PERF_COUNT_HW_INSTRUCTIONS,
+                                           PERF_COUNT_HW_BRANCH_MISSES };
+    for (int i = 0; i < COUNT; ++i)
+    {
+      perf_event_attr attr{};
+      attr.size = sizeof (attr);
+      attr.type = PERF_TYPE_HARDWARE;
+      attr.config = configs[i];
+      attr.disabled = i == 0;
+      attr.exclude_kernel = 1;
+      attr.exclude_hv = 1;
+      attr.read_format = PERF_FORMAT_GROUP;
+      // the first counter leads the group, so all start and stop together
+      m_fds[i] = static_cast<int> (
+        syscall (SYS_perf_event_open, &attr, 0, -1, i == 0 ? -1 : m_fds[0], 0));
+      if (m_fds[i] < 0)
+      {
+        close_all ();
+        return;
+      }
+    }
+#endif
+  }
+
+  PerfCounters (PerfCounters const&) = delete;
+  PerfCounters&
+  operator= (PerfCounters const&) = delete;
+
+  ~PerfCounters ()
+  {
+    close_all ();
+  }
+
+  bool
+  ok () const
+  {
+    return m_fds[0] >= 0;
+  }
+
+  void
+  start ()
+  {
+#ifdef __linux__
+    if (ok ())
+    {
+      ioctl (m_fds[0], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+      ioctl (m_fds[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+    }
+#endif
+  }
+
+  Values
+  stop ()
+  {
+    Values values{};
+#ifdef __linux__
+    if (ok ())
+    {
+      ioctl (m_fds[0], PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+      // PERF_FORMAT_GROUP: the number of counters, then each value
+      std::uint64_t buf[COUNT + 1] = {};
+      if (read (m_fds[0], buf, sizeof (buf)) == sizeof (buf))
+      {
+        std::copy (buf + 1, buf + 1 + COUNT, values.begin ());
+      }
+    }
+#endif
+    return values;
+  }
+
+private:
+  void
+  close_all ()
+  {
+#ifdef __linux__
+    for (int& fd : m_fds)
+    {
+      if (fd >= 0)
+      {
+        close (fd);
+      }
+      fd = -1;
+    }
+#endif
+  }
+
+  int m_fds[COUNT] = { -1, -1, -1 };
+};
+
+// An int that counts every copy and move of itself, for the untimed
+// counting run
+//
+struct Counted
+{
+  static inline std::uint64_t moves = 0;
+
+  int value = 0;
+
+  Counted () = default;
+
+  explicit Counted (int v) : value (v)
+  {
+  }
+
+  Counted (Counted const& other) : value (other.value)
+  {
+    ++moves;
+  }
+
+  Counted&
+  operator= (Counted const& other)
+  {
+    value = other.value;
+    ++moves;
+    return *this;
+  }
+};
+
+// One input order: a name and a function filling a vector of n ints
+struct Distribution
+{
+  std::string name;
+  std::function<std::vector<int> (std::size_t, std::mt19937&)> make;
+};
+
+// One algorithm, called with the default comparator on ints and with
+// a counting comparator on Counted
+struct Algorithm
+{
+  std::string name;
+  std::function<void (std::vector<int>&)> sort;
+  std::function<void (std::vector<Counted>&, std::function<bool (Counted const&, Counted const&)>)>
+    countedSort;
+};
+
+// What one algorithm did to one input
+struct Result
+{
+  std::string algorithm;
+  std::string distribution;
+  std::size_t n;
+  double nsPerElement;
+  std::uint64_t comparisons;
+  std::uint64_t moves;
+  bool haveCounters;
+  PerfCounters::Values counters;
+};
+
+// Draw n values from a Zipf distribution over 1 .. "values": value k
+// comes up in proportion to 1 / k
+//
+std::vector<int>
+zipf (std::size_t n, int values, std::mt19937& rng)
+{
+  std::vector<double> cdf (values);
+  double sum = 0;
+  for (int k = 0; k < values; ++k)
+  {
+    sum += 1.0 / (k + 1);
+    cdf[k] = sum;
+  }
+  std::uniform_real_distribution<double> uniform (0, sum);
+  std::vector<int> v (n);
+  for (int& x : v)
+  {
+    auto const k = std::upper_bound (cdf.begin (), cdf.end (), uniform (rng))
+                   - cdf.begin ();
+    x = static_cast<int> (k < values ? k + 1 : values);
+  }
+  return v;
+}
+
+std::vector<Distribution>
+distributions ()
+{
+  return {
+    { "random",
+      [] (std::size_t n, std::mt19937& rng) {
+        std::vector<int> v (n);
+        for (int& x : v)
+        {
+          x = static_cast<int> (rng ());
+        }
+        return v;
+      } },
+    { "sorted",
+      [] (std::size_t n, std::mt19937&) {
+        std::vector<int> v (n);
+        for (std::size_t i = 0; i < n; ++i)
+        {
+          v[i] = static_cast<int> (i);
+        }
+        return v;
+      } },
+    { "reversed",
+      [] (std::size_t n, std::mt19937&) {
+        std::vector<int> v (n);
+        for (std::size_t i = 0; i < n; ++i)
+        {
+          v[i] = static_cast<int> (n - i);
+        }
+        return v;
+      } },
+    { "few-unique",
+      [] (std::size_t n, std::mt19937& rng) {
+        std::vector<int> v (n);
+        for (int& x : v)
+        {
+          x = static_cast<int> (rng () % 16);
+        }
+        return v;
+      } },
+    { "organ-pipe",
+      [] (std::size_t n, std::mt19937&) {
+        std::vector<int> v (n);
+        for (std::size_t i = 0; i < n; ++i)
+        {
+          v[i] = static_cast<int> (i < n / 2 ? i : n - i);
+        }
+        return v;
+      } },
+    { "zipf",
+      [] (std::size_t n, std::mt19937& rng) { return zipf (n, 1000, rng); } },
+  };
+}
+
+std::vector<Algorithm>
+algorithms ()
+{
+  using Less = std::function<bool (Counted const&, Counted const&)>;
+  return {
+    { "insertion_sort",
+      [] (std::vector<int>& v) { SortUtils::insertion_sort (v.begin (), v.end ()); },
+      [] (std::vector<Counted>& v, Less less) {
+        SortUtils::insertion_sort (v.begin (), v.end (), less);
+      } },
+    { "merge_sort",
+      [] (std::vector<int>& v) { SortUtils::merge_sort (v.begin (), v.end ()); },
+      [] (std::vector<Counted>& v, Less less) {
+        SortUtils::merge_sort (v.begin (), v.end (), less);
+      } },
+    { "tim_sort",
+      [] (std::vector<int>& v) { SortUtils::tim_sort (v.begin (), v.end ()); },
+      [] (std::vector<Counted>& v, Less less) {
+        SortUtils::tim_sort (v.begin (), v.end (), less);
+      } },
+    { "quick_sort",
+      [] (std::vector<int>& v) { SortUtils::quick_sort (v.begin (), v.end ()); },
+      [] (std::vector<Counted>& v, Less less) {
+        SortUtils::quick_sort (v.begin (), v.end (), less);
+      } },
+    { "heap_sort",
+      [] (std::vector<int>& v) { SortUtils::heap_sort (v.begin (), v.end ()); },
+      [] (std::vector<Counted>& v, Less less) {
+        SortUtils::heap_sort (v.begin (), v.end (), less);
+      } },
+    { "std::sort",
+      [] (std::vector<int>& v) { std::sort (v.begin (), v.end ()); },
+      [] (std::vector<Counted>& v, Less less) {
+        std::sort (v.begin (), v.end (), less);
+      } },
+    { "std::stable_sort",
+      [] (std::vector<int>& v) { std::stable_sort (v.begin (), v.end ()); },
+      [] (std::vector<Counted>& v, Less less) {
+        std::stable_sort (v.begin (), v.end (), less);
+      } },
+  };
+}
+
+// Time "algorithm" on "input", and count its comparisons and moves.
+// Exits if it ever fails to sort
+//
+Result
+run (Algorithm const& algorithm, std::string const& distribution,
+     std::vector<int> const& input, PerfCounters& perf)
+{
+  std::size_t const n = input.size ();
+  std::vector<int> expected (input);
+  std::sort (expected.begin (), expected.end ());
+
+  Result result{ algorithm.name, distribution, n, 0, 0, 0, perf.ok (), {} };
+  std::size_t const budgetReps = TIME_BUDGET / (n == 0 ? 1 : n);
+  int const reps = budgetReps > MIN_REPS ? static_cast<int> (budgetReps) : MIN_REPS;
+  double best = std::numeric_limits<double>::infinity ();
+  for (int r = 0; r < reps; ++r)
+  {
+    std::vector<int> v (input);
+    perf.start ();
+    auto const start = std::chrono::steady_clock::now ();
+    algorithm.sort (v);
+    std::chrono::duration<double, std::nano> const elapsed =
+      std::chrono::steady_clock::now () - start;
+    PerfCounters::Values const counters = perf.stop ();
+    if (v != expected)
+    {
+      std::cerr << algorithm.name << " failed to sort " << distribution << '\n';
+      std::exit (EXIT_FAILURE);
+    }
+    if (elapsed.count () < best)
+    {
+      best = elapsed.count ();
+      result.counters = counters;
+    }
+  }
+  result.nsPerElement = best / (n == 0 ? 1 : n);
+
+  std::vector<Counted> counted;
+  counted.reserve (n);
+  for (int x : input)
+  {
+    counted.emplace_back (x);
+  }
+  std::uint64_t comparisons = 0;
+  Counted::moves = 0;
+  algorithm.countedSort (counted, [&] (Counted const& a, Counted const& b) {
+    ++comparisons;
+    return a.value < b.value;
+  });
+  result.comparisons = comparisons;
+  result.moves = Counted::moves;
+  return result;
+}
+
+void
+write_json (std::ostream& out, std::vector<Result> const& results)
+{
+  out << "{\n  \"benchmark\": \"sorts1\",\n  \"results\": [";
+  for (std::size_t i = 0; i < results.size (); ++i)
+  {
+    Result const& r = results[i];
+    out << (i == 0 ? "" : ",") << "\n    { \"algorithm\": \"" << r.algorithm
+        << "\", \"distribution\": \"" << r.distribution << "\", \"n\": " << r.n
+        << ", \"ns_per_element\": " << r.nsPerElement
+        << ", \"comparisons\": " << r.comparisons << ", \"moves\": " << r.moves;
+    for (int c = 0; c < PerfCounters::COUNT; ++c)
+    {
+      out << ", \"" << PerfCounters::NAMES[c] << "\": ";
+      if (r.haveCounters)
+      {
+        out << r.counters[c];
+      }
+      else
+      {
+        out << "null";
+      }
+    }
+    out << " }";
+  }
+  out << "\n  ]\n}\n";
+}
+
+int
+main (int argc, char* argv[])
+{
+  bool wantCounters = false;
+  std::string jsonPath;
+  std::vector<std::size_t> sizes;
+  for (int i = 1; i < argc; ++i)
+  {
+    std::string const arg = argv[i];
+    if (arg == "--counters")
+    {
+      wantCounters = true;
+    }
+    else if (arg == "--json" && i + 1 < argc)
+    {
+      jsonPath = argv[++i];
+    }
+    else if (!arg.empty () && arg[0] != '-')
+    {
+      sizes.push_back (std::stoul (arg));
+    }
+    else
+    {
+      std::cerr << "usage: " << argv[0] << " [--counters] [--json FILE] [N ...]\n";
+      return EXIT_FAILURE;
+    }
+  }
+  if (sizes.empty ())
+  {
+    sizes = { 1000, 100000, 1000000 };
+  }
+
+  PerfCounters counters (wantCounters);
+  if (wantCounters && !counters.ok ())
+  {
+    std::cerr << "perf_event counters unavailable; timing only\n";
+  }
+
+  std::cout << std::fixed << std::setprecision (2) << std::left
+            << std::setw (17) << "algorithm" << std::setw (11) << "input"
+            << std::right << std::setw (9) << "n" << std::setw (10) << "ns/elem"
+            << std::setw (10) << "cmp/elem" << std::setw (11) << "moves/elem";
+  if (counters.ok ())
+  {
+    std::cout << std::setw (12) << "cycles/elem" << std::setw (11) << "IPC"
+              << std::setw (13) << "brmiss/elem";
+  }
+  std::cout << '\n';
+
+  std::vector<Result> results;
+  for (std::size_t n : sizes)
+  {
+    for (Distribution const& distribution : distributions ())
+    {
+      std::mt19937 rng{2047};
+      std::vector<int> const input = distribution.make (n, rng);
+      for (Algorithm const& algorithm : algorithms ())
+      {
+        if (algorithm.name == "insertion_sort" && n > INSERTION_MAX)
+        {
+          continue;
+        }
+        Result const r = run (algorithm, distribution.name, input, counters);
+        double const perElement = n == 0 ? 0 : 1.0 / n;
+        std::cout << std::left << std::setw (17) << r.algorithm << std::setw (11)
+                  << r.distribution << std::right << std::setw (9) << r.n
+                  << std::setw (10) << r.nsPerElement << std::setw (10)
+                  << r.comparisons * perElement << std::setw (11)
+                  << r.moves * perElement;
+        if (r.haveCounters)
+        {
+          double const cycles = static_cast<double> (r.counters[0]);
+          std::cout << std::setw (12) << cycles * perElement << std::setw (11)
+                    << (cycles == 0 ? 0 : r.counters[1] / cycles)
+                    << std::setw (13) << r.counters[2] * perElement;
+        }
+        std::cout << '\n';
+        results.push_back (r);
+      }
+    }
+  }
+
+  if (!jsonPath.empty ())
+  {
+    std::ofstream json (jsonPath);
+    write_json (json, results);
+    if (!json)
+    {
+      std::cerr << "could not write " << jsonPath << '\n';
+      return EXIT_FAILURE;
+    }
+  }
+}
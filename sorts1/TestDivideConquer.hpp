@@ -1,6 +1,16 @@
 #include "DivideAndConquer.hpp"
+#include "ExternalSort.hpp"
+#include "ParallelSort.hpp"
+#include "RadixSort.hpp"
+#include "TimSort.hpp"
 
+#include <cstdint>
+#include <cstdio>
+#include <limits>
+#include <memory>
+#include <sstream>
 #include <iterator>
+#include <string>
 #include <vector>
 
 SCENARIO ("median3 works", "[median3]")
@@ -263,6 +273,70 @@ SCENARIO ("partition works", "[partition]")
   }
 }
 
+// Run fast_partition on "v" and check its groups against the pivot
+template<typename T>
+void
+check_fast_partition (std::vector<T> v, T const& pivot)
+{
+  std::vector<T> copy (v);
+  auto [p1, p2] = SortUtils::fast_partition (v.begin (), v.end (), pivot);
+  for (auto i = v.begin (); i != p1; ++i)
+    REQUIRE (*i < pivot);
+  for (auto i = p1; i != p2; ++i)
+    REQUIRE (*i == pivot);
+  for (auto i = p2; i != v.end (); ++i)
+    REQUIRE (*i > pivot);
+  std::sort (v.begin (), v.end ());
+  std::sort (copy.begin (), copy.end ());
+  REQUIRE (v == copy);
+}
+
+SCENARIO ("fast_partition agrees with partition", "[partition]")
+{
+  using SortUtils::PartitionSimd::Isa;
+  GIVEN ("Vectors of many types, sizes and instruction sets")
+  {
+    Isa const isa = GENERATE (Isa::Scalar, Isa::Avx2, Isa::Avx512);
+    int const n = GENERATE (5, 64, 100, 1000, 10007);
+    std::minstd_rand rng (n);
+    std::vector<int> keys (n);
+    for (int& k : keys)
+    {
+      k = static_cast<int> (rng () % 50) - 25;
+    }
+    int const pivot = keys[n / 3];
+    Isa const detected = SortUtils::PartitionSimd::detect_isa ();
+    SortUtils::PartitionSimd::active_isa () = isa < detected ? isa : detected;
+    CAPTURE (n, static_cast<int> (SortUtils::PartitionSimd::active_isa ()));
+    WHEN ("We call fast_partition")
+    {
+      THEN ("Each group is where it belongs")
+      {
+        check_fast_partition (keys, pivot);
+        check_fast_partition (std::vector<std::uint32_t> (keys.begin (), keys.end ()),
+                              std::uint32_t (pivot));
+        check_fast_partition (std::vector<std::int64_t> (keys.begin (), keys.end ()),
+                              std::int64_t (pivot) - (std::int64_t (1) << 40));
+        check_fast_partition (std::vector<std::uint64_t> (keys.begin (), keys.end ()),
+                              std::uint64_t (pivot));
+        check_fast_partition (std::vector<float> (keys.begin (), keys.end ()),
+                              float (pivot) / 2);
+        check_fast_partition (std::vector<double> (keys.begin (), keys.end ()),
+                              double (pivot));
+        check_fast_partition (std::vector<short> (keys.begin (), keys.end ()),
+                              short (pivot));
+        std::vector<std::string> words;
+        for (int k : keys)
+        {
+          words.push_back (std::to_string (k));
+        }
+        check_fast_partition (words, std::to_string (pivot));
+      }
+    }
+    SortUtils::PartitionSimd::active_isa () = detected;
+  }
+}
+
 SCENARIO ("nth_element works", "[nth_element]")
 {
   std::vector<int> v (40);
@@ -320,6 +394,31 @@ SCENARIO ("merge_sort works", "[merge_sort]")
       }
     }
   }
+  GIVEN ("Move-only elements")
+  {
+    // an even and an odd number of merge passes
+    std::size_t const n = GENERATE (31, 33, 100, 1000);
+    std::vector<std::unique_ptr<int>> v;
+    std::minstd_rand rng{2047};
+    for (std::size_t i = 0; i < n; ++i)
+    {
+      v.push_back (std::make_unique<int> (static_cast<int> (rng () % 50)));
+    }
+    CAPTURE (n);
+    WHEN ("We merge_sort by the pointed-to value")
+    {
+      SortUtils::merge_sort (v.begin (), v.end (), std::less<> (),
+                             [] (std::unique_ptr<int> const& p) { return *p; });
+      THEN ("Nothing was copied and the values are in order")
+      {
+        REQUIRE (v.size () == n);
+        for (std::size_t i = 1; i < n; ++i)
+        {
+          REQUIRE (*v[i - 1] <= *v[i]);
+        }
+      }
+    }
+  }
 }
 
 
@@ -343,3 +442,646 @@ SCENARIO ("quick_sort works", "[quick_sort]")
     }
   }
 }
+
+SCENARIO ("quick_sort handles large and adversarial inputs", "[quick_sort]")
+{
+  GIVEN ("A large vector in an awkward order")
+  {
+    int const shape = GENERATE (0, 1, 2, 3, 4);
+    std::vector<int> v (20000);
+    for (int i = 0; i < static_cast<int> (v.size ()); ++i)
+    {
+      int const n = static_cast<int> (v.size ());
+      int const values[] = {i, n - i, 7, std::min (i, n - i), i % 97};
+      v[i] = values[shape];
+    }
+    CAPTURE (shape);
+    std::vector<int> expected (v);
+    std::sort (expected.begin (), expected.end ());
+    WHEN ("We call quick_sort")
+    {
+      SortUtils::quick_sort (v.begin (), v.end ());
+      THEN ("We get the right answer")
+      {
+        REQUIRE (expected == v);
+      }
+    }
+  }
+}
+
+SCENARIO ("heap_sort works", "[heap_sort]")
+{
+  GIVEN ("A vector with duplicates")
+  {
+    std::vector<int> v (1000);
+    std::iota (v.begin (), v.end (), -300);
+    std::transform (v.begin (), v.end (), v.begin (), [] (int x) { return x % 113; });
+    std::shuffle (v.begin (), v.end (), std::minstd_rand{2047});
+    std::vector<int> expected (v);
+    std::sort (expected.begin (), expected.end ());
+    WHEN ("We call heap_sort")
+    {
+      SortUtils::heap_sort (v.begin (), v.end ());
+      THEN ("We get the right answer")
+      {
+        REQUIRE (expected == v);
+      }
+    }
+  }
+}
+
+SCENARIO ("merge_sort with a caller-provided buffer", "[merge_sort]")
+{
+  GIVEN ("A large vector of (key, position) pairs with many equal keys")
+  {
+    int const size = GENERATE (1, 33, 1000, 100003);
+    std::vector<std::pair<int, int>> v (size);
+    std::minstd_rand rng{2047};
+    for (int i = 0; i < size; ++i)
+    {
+      v[i] = {static_cast<int> (rng () % 50), i};
+    }
+    std::vector<std::pair<int, int>> expected (v);
+    std::stable_sort (expected.begin (), expected.end (),
+                      [] (auto const& a, auto const& b) { return a.first < b.first; });
+    WHEN ("We call merge_sort on the keys only")
+    {
+      struct ByKey
+      {
+        std::pair<int, int> p;
+        bool operator< (ByKey const& o) const { return p.first < o.p.first; }
+        bool operator> (ByKey const& o) const { return o < *this; }
+      };
+      std::vector<ByKey> keys (size);
+      std::vector<ByKey> scratch (size);
+      for (int i = 0; i < size; ++i)
+      {
+        keys[i].p = v[i];
+      }
+      SortUtils::merge_sort (keys.begin (), keys.end (), scratch.begin ());
+      for (int i = 0; i < size; ++i)
+      {
+        v[i] = keys[i].p;
+      }
+      THEN ("Equal keys keep their original order")
+      {
+        REQUIRE (expected == v);
+      }
+    }
+  }
+}
+
+SCENARIO ("parallel sorts work", "[parallel]")
+{
+  GIVEN ("A pool and a large vector with duplicates")
+  {
+    unsigned const threads = GENERATE (1u, 4u);
+    int const grain = GENERATE (64, 4096);
+    SortUtils::WorkStealingPool pool (threads);
+    std::vector<int> v (50000);
+    std::minstd_rand rng{2047};
+    for (int& x : v)
+    {
+      x = static_cast<int> (rng () % 20000);
+    }
+    std::vector<int> expected (v);
+    std::sort (expected.begin (), expected.end ());
+    CAPTURE (threads, grain);
+    WHEN ("We call parallel_merge_sort")
+    {
+      SortUtils::parallel_merge_sort (v.begin (), v.end (), pool, grain);
+      THEN ("We get the right answer")
+      {
+        REQUIRE (expected == v);
+      }
+    }
+    WHEN ("We call parallel_quick_sort")
+    {
+      SortUtils::parallel_quick_sort (v.begin (), v.end (), pool, grain);
+      THEN ("We get the right answer")
+      {
+        REQUIRE (expected == v);
+      }
+    }
+    WHEN ("We call parallel_quick_sort on sorted input")
+    {
+      std::sort (v.begin (), v.end ());
+      SortUtils::parallel_quick_sort (v.begin (), v.end (), pool, grain);
+      THEN ("We get the right answer")
+      {
+        REQUIRE (expected == v);
+      }
+    }
+  }
+  GIVEN ("A pool and a large vector of strings")
+  {
+    unsigned const threads = GENERATE (1u, 4u);
+    int const grain = GENERATE (64, 4096);
+    SortUtils::WorkStealingPool pool (threads);
+    std::vector<std::string> v (20000);
+    std::minstd_rand rng{2047};
+    for (std::string& s : v)
+    {
+      // long enough to live on the heap, so a moved-from string is empty
+      s = "a string long enough to be allocated #" + std::to_string (rng () % 5000);
+    }
+    std::vector<std::string> expected (v);
+    std::sort (expected.begin (), expected.end ());
+    CAPTURE (threads, grain);
+    WHEN ("We call parallel_merge_sort")
+    {
+      SortUtils::parallel_merge_sort (v.begin (), v.end (), pool, grain);
+      THEN ("We get the right answer")
+      {
+        REQUIRE (expected == v);
+      }
+    }
+    WHEN ("We call parallel_quick_sort")
+    {
+      SortUtils::parallel_quick_sort (v.begin (), v.end (), pool, grain);
+      THEN ("We get the right answer")
+      {
+        REQUIRE (expected == v);
+      }
+    }
+    WHEN ("parallel_quick_sort runs out of depth at once")
+    {
+      std::vector<std::string> buf (v);
+      SortUtils::parallel_quick_sort_loop (v.begin (), buf.begin (),
+                                           static_cast<std::ptrdiff_t> (v.size ()),
+                                           0, pool, grain);
+      THEN ("The merge sort fallback gets the right answer")
+      {
+        REQUIRE (expected == v);
+      }
+    }
+  }
+}
+
+// Sort a copy of "v" with each radix sort (and counting_sort, if
+// "counting") and check it against std::sort
+template<typename T>
+void
+check_radix_sorts (std::vector<T> const& v, bool counting = false)
+{
+  std::vector<T> expected (v);
+  std::sort (expected.begin (), expected.end ());
+  std::vector<T> lsd (v), msd (v), any (v);
+  SortUtils::lsd_radix_sort (lsd.begin (), lsd.end ());
+  REQUIRE (lsd == expected);
+  SortUtils::msd_radix_sort (msd.begin (), msd.end ());
+  REQUIRE (msd == expected);
+  SortUtils::sort (any.begin (), any.end ());
+  REQUIRE (any == expected);
+  if constexpr (std::is_integral_v<T>)
+  {
+    if (!counting)
+    {
+      return;
+    }
+    std::vector<T> counted (v);
+    SortUtils::counting_sort (counted.begin (), counted.end ());
+    REQUIRE (counted == expected);
+  }
+}
+
+SCENARIO ("radix and counting sorts work", "[radix]")
+{
+  GIVEN ("Vectors of integers and floats")
+  {
+    int const n = GENERATE (0, 1, 31, 300, 20000);
+    int const spread = GENERATE (10, 100000, std::numeric_limits<int>::max ());
+    std::minstd_rand rng (n);
+    std::vector<int> keys (n);
+    for (int& k : keys)
+    {
+      k = static_cast<int> (rng () % spread) - spread / 2;
+    }
+    CAPTURE (n, spread);
+    WHEN ("We radix sort them")
+    {
+      THEN ("We get the right answer")
+      {
+        check_radix_sorts (keys, spread <= 100000);
+        check_radix_sorts (std::vector<short> (keys.begin (), keys.end ()), true);
+        check_radix_sorts (std::vector<unsigned char> (keys.begin (), keys.end ()),
+                           true);
+        std::vector<std::uint64_t> wide;
+        std::vector<std::int64_t> signedWide;
+        std::vector<float> floats;
+        std::vector<double> doubles;
+        for (int k : keys)
+        {
+          wide.push_back (std::uint64_t (k) * 2654435761u);
+          signedWide.push_back (std::int64_t (k) * (std::int64_t (1) << 20));
+          floats.push_back (k / 7.0f);
+          doubles.push_back (k == 3 ? -std::numeric_limits<double>::infinity ()
+                                    : k * 1e-3);
+        }
+        check_radix_sorts (wide);
+        check_radix_sorts (signedWide);
+        check_radix_sorts (floats);
+        check_radix_sorts (doubles);
+      }
+    }
+  }
+}
+
+// A plain function comparator, which has iterator_traits of its own
+inline bool
+greater_int (int const& a, int const& b)
+{
+  return a > b;
+}
+
+SCENARIO ("comparators and projections work", "[projection]")
+{
+  struct Record
+  {
+    int key;
+    int order;
+  };
+  GIVEN ("Records with repeated keys")
+  {
+    int const n = GENERATE (1, 50, 5000);
+    std::minstd_rand rng (n);
+    std::vector<Record> v;
+    for (int i = 0; i < n; ++i)
+    {
+      v.push_back ({static_cast<int> (rng () % 100), i});
+    }
+    auto const byKey = [] (Record const& a, Record const& b) {
+      return a.key < b.key;
+    };
+    std::vector<Record> expected (v);
+    std::stable_sort (expected.begin (), expected.end (), byKey);
+    auto const keys = [] (std::vector<Record> const& r) {
+      std::vector<int> k;
+      for (Record const& x : r)
+      {
+        k.push_back (x.key);
+      }
+      return k;
+    };
+    auto const orders = [] (std::vector<Record> const& r) {
+      std::vector<int> o;
+      for (Record const& x : r)
+      {
+        o.push_back (x.order);
+      }
+      return o;
+    };
+    CAPTURE (n);
+    WHEN ("We merge_sort by key")
+    {
+      SortUtils::merge_sort (v.begin (), v.end (), std::less<> (), &Record::key);
+      THEN ("The sort is stable")
+      {
+        REQUIRE (orders (v) == orders (expected));
+      }
+    }
+    WHEN ("We quick_sort by key")
+    {
+      SortUtils::quick_sort (v.begin (), v.end (), std::less<> (), &Record::key);
+      THEN ("The keys are in order")
+      {
+        REQUIRE (keys (v) == keys (expected));
+      }
+    }
+    WHEN ("We quick_sort and insertion_sort with a comparator")
+    {
+      std::vector<Record> w (v);
+      SortUtils::quick_sort (v.begin (), v.end (), std::greater<> (),
+                             [] (Record const& r) { return r.key; });
+      SortUtils::insertion_sort (w.begin (), w.end (), [] (Record const& a, Record const& b) {
+        return a.key > b.key;
+      });
+      THEN ("The keys are in descending order")
+      {
+        std::vector<int> descending = keys (expected);
+        std::reverse (descending.begin (), descending.end ());
+        REQUIRE (keys (v) == descending);
+        REQUIRE (keys (w) == descending);
+      }
+    }
+    WHEN ("We merge_sort by key with a free function")
+    {
+      std::vector<int> k = keys (v);
+      std::vector<int> scratch (k.size ());
+      std::vector<int> w (k);
+      SortUtils::merge_sort (k.begin (), k.end (), &greater_int);
+      SortUtils::merge_sort (w.begin (), w.end (), scratch.begin (), greater_int);
+      THEN ("The keys are in descending order")
+      {
+        std::vector<int> descending = keys (expected);
+        std::reverse (descending.begin (), descending.end ());
+        REQUIRE (k == descending);
+        REQUIRE (w == descending);
+      }
+    }
+    WHEN ("We call nth_element and partition by key")
+    {
+      std::size_t const k = n / 3;
+      int const nth = SortUtils::nth_element (v.begin (), v.end (), k, std::less<> (),
+                                              &Record::key)->key;
+      auto [p1, p2] = SortUtils::partition (v.begin (), v.end (), 50,
+                                            std::less<> (), &Record::key);
+      THEN ("We get the right answer")
+      {
+        REQUIRE (nth == expected[k].key);
+        for (auto i = v.begin (); i != v.end (); ++i)
+        {
+          int const group = i < p1 ? 0 : i < p2 ? 1 : 2;
+          REQUIRE (group == (i->key < 50 ? 0 : i->key == 50 ? 1 : 2));
+        }
+      }
+    }
+  }
+}
+
+// McIlroy's "killer adversary": it decides the elements' values only
+// as they are compared, so that every pivot is as bad as it can be
+struct Adversary
+{
+  explicit Adversary (int n)
+    : value (n, n), gas (n)
+  {
+  }
+
+  bool
+  less (int x, int y)
+  {
+    ++comparisons;
+    if (value[x] == gas && value[y] == gas)
+    {
+      value[x == candidate ? x : y] = solid++;
+    }
+    if (value[x] == gas)
+    {
+      candidate = x;
+    }
+    else if (value[y] == gas)
+    {
+      candidate = y;
+    }
+    return value[x] < value[y];
+  }
+
+  std::vector<int> value;
+  int gas;
+  int solid = 0;
+  int candidate = 0;
+  long long comparisons = 0;
+};
+
+SCENARIO ("nth_element runs in linear time", "[nth_element]")
+{
+  GIVEN ("An adversarial comparator")
+  {
+    int const n = 20000;
+    Adversary adversary (n);
+    std::vector<int> v (n);
+    std::iota (v.begin (), v.end (), 0);
+    WHEN ("We select the median")
+    {
+      SortUtils::nth_element (v.begin (), v.end (), n / 2, [&] (int x, int y) {
+        return adversary.less (x, y);
+      });
+      THEN ("It takes O(N) comparisons")
+      {
+        REQUIRE (adversary.comparisons < 20LL * n);
+      }
+    }
+  }
+  GIVEN ("Large vectors in awkward orders")
+  {
+    int const shape = GENERATE (0, 1, 2, 3);
+    int const n = 10007;
+    std::vector<int> v (n);
+    for (int i = 0; i < n; ++i)
+    {
+      int const values[] = {i, n - i, i % 7, std::min (i, n - i)};
+      v[i] = values[shape];
+    }
+    std::vector<int> sorted (v);
+    std::sort (sorted.begin (), sorted.end ());
+    int const index = GENERATE (0, 17, 5003, 10006);
+    CAPTURE (shape, index);
+    WHEN ("We call nth_element")
+    {
+      auto result = SortUtils::nth_element (v.begin (), v.end (), index);
+      THEN ("We get the right element, partitioned around it")
+      {
+        REQUIRE (result - v.begin () == index);
+        REQUIRE (*result == sorted[index]);
+        for (auto i = v.begin (); i != result; ++i)
+          REQUIRE (!(*result < *i));
+        for (auto i = result; i != v.end (); ++i)
+          REQUIRE (!(*i < *result));
+      }
+    }
+  }
+}
+
+SCENARIO ("partial_sort and top_k work", "[partial_sort]")
+{
+  GIVEN ("A vector with duplicates")
+  {
+    int const n = 5000;
+    std::vector<int> v (n);
+    std::minstd_rand rng (n);
+    for (int& x : v)
+    {
+      x = static_cast<int> (rng () % 1000);
+    }
+    std::vector<int> sorted (v);
+    std::sort (sorted.begin (), sorted.end ());
+    std::ostringstream text;
+    for (int x : v)
+    {
+      text << x << ' ';
+    }
+    int const k = GENERATE (0, 1, 100, 4999, 5000);
+    CAPTURE (k);
+    WHEN ("We call partial_sort")
+    {
+      SortUtils::partial_sort (v.begin (), v.begin () + k, v.end ());
+      THEN ("The first k are the smallest, in order")
+      {
+        REQUIRE (std::equal (v.begin (), v.begin () + k, sorted.begin ()));
+        std::sort (v.begin (), v.end ());
+        REQUIRE (v == sorted);
+      }
+    }
+    WHEN ("We call partial_sort_copy on a stream")
+    {
+      std::istringstream in (text.str ());
+      std::vector<int> out (k);
+      auto end = SortUtils::partial_sort_copy (std::istream_iterator<int> (in),
+                                               std::istream_iterator<int> (),
+                                               out.begin (), out.end ());
+      THEN ("We get the k smallest, in order")
+      {
+        REQUIRE (end == out.end ());
+        REQUIRE (std::equal (out.begin (), end, sorted.begin ()));
+      }
+    }
+    WHEN ("We call partial_sort_copy with room to spare")
+    {
+      // every input is smaller than the sentinel, so a stray write
+      // past the destination would replace it
+      std::vector<int> out (k + 1, std::numeric_limits<int>::max ());
+      auto end = SortUtils::partial_sort_copy (v.begin (), v.end (), out.begin (),
+                                               out.begin () + k);
+      THEN ("Nothing past the destination is touched")
+      {
+        REQUIRE (end - out.begin () == k);
+        REQUIRE (std::equal (out.begin (), end, sorted.begin ()));
+        REQUIRE (out[k] == std::numeric_limits<int>::max ());
+      }
+    }
+    WHEN ("We ask a stream for the k largest")
+    {
+      std::istringstream in (text.str ());
+      std::vector<int> best =
+        SortUtils::top_k (std::istream_iterator<int> (in),
+                          std::istream_iterator<int> (), k, std::greater<> ());
+      THEN ("We get the k largest, largest first")
+      {
+        REQUIRE (best.size () == std::size_t (k));
+        REQUIRE (std::equal (best.begin (), best.end (), sorted.rbegin ()));
+      }
+    }
+    WHEN ("We ask for more than there are")
+    {
+      std::vector<int> best = SortUtils::top_k (v.begin (), v.begin () + k, k + 10);
+      std::vector<int> out (k + 10);
+      auto end = SortUtils::partial_sort_copy (v.begin (), v.begin () + k,
+                                               out.begin (), out.end ());
+      THEN ("We get all of them, in order")
+      {
+        std::vector<int> expected (v.begin (), v.begin () + k);
+        std::sort (expected.begin (), expected.end ());
+        REQUIRE (best == expected);
+        REQUIRE (std::vector<int> (out.begin (), end) == expected);
+      }
+    }
+  }
+}
+
+SCENARIO ("external_sort works", "[external_sort]")
+{
+  GIVEN ("More data than the memory budget")
+  {
+    int const n = GENERATE (0, 1000, 100000);
+    std::vector<int> v (n);
+    std::minstd_rand rng (n);
+    for (int& x : v)
+    {
+      x = static_cast<int> (rng ());
+    }
+    std::vector<int> expected (v);
+    std::sort (expected.begin (), expected.end ());
+    // 4096 ints per run, and a fan-in of 3
+    SortUtils::ExternalSortOptions options;
+    options.memoryBytes = 16 << 10;
+    options.blockBytes = 2 << 10;
+    CAPTURE (n);
+    WHEN ("We sort from one iterator to another")
+    {
+      std::vector<int> out;
+      auto stats = SortUtils::external_sort (v.begin (), v.end (),
+                                             std::back_inserter (out), options);
+      THEN ("We get the right answer")
+      {
+        REQUIRE (out == expected);
+        REQUIRE (stats.elements == std::size_t (n));
+        REQUIRE (stats.runs == std::size_t ((n + 4095) / 4096));
+        REQUIRE (stats.mergePasses == (n > 4096 ? 3u : 0u));
+      }
+    }
+    WHEN ("We sort a file in place")
+    {
+      SortUtils::TempFile file ("");
+      std::FILE* f = std::fopen (file.path ().c_str (), "wb");
+      if (!v.empty ())
+      {
+        std::fwrite (v.data (), sizeof (int), v.size (), f);
+      }
+      std::fclose (f);
+      SortUtils::external_sort<int> (file.path (), file.path (), options,
+                                     std::greater<> ());
+      std::vector<int> out (n + 1);
+      f = std::fopen (file.path ().c_str (), "rb");
+      out.resize (std::fread (out.data (), sizeof (int), out.size (), f));
+      std::fclose (f);
+      THEN ("We get the right answer")
+      {
+        std::reverse (expected.begin (), expected.end ());
+        REQUIRE (out == expected);
+      }
+    }
+  }
+}
+
+SCENARIO ("tim_sort works", "[tim_sort]")
+{
+  GIVEN ("(key, position) pairs in a variety of orders")
+  {
+    int const n = GENERATE (0, 1, 2, 63, 64, 65, 1000, 100003);
+    // random, sorted, reversed, sawtooth, sorted but for a few swaps
+    int const shape = GENERATE (0, 1, 2, 3, 4);
+    std::minstd_rand rng (n);
+    std::vector<std::pair<int, int>> v (n);
+    for (int i = 0; i < n; ++i)
+    {
+      int key = static_cast<int> (rng () % 1000);
+      switch (shape)
+      {
+      case 1: key = i / 3; break;
+      case 2: key = n - i; break;
+      case 3: key = i % 1000; break;
+      default: break;
+      }
+      v[i] = {key, i};
+    }
+    if (shape == 4)
+    {
+      for (int i = 0; i < n; ++i)
+      {
+        v[i].first = i;
+      }
+      for (int i = 0; n > 0 && i < 10; ++i)
+      {
+        std::swap (v[rng () % n].first, v[rng () % n].first);
+      }
+    }
+    auto const byKey = [] (auto const& a, auto const& b) {
+      return a.first < b.first;
+    };
+    std::vector<std::pair<int, int>> expected (v);
+    std::stable_sort (expected.begin (), expected.end (), byKey);
+    CAPTURE (n, shape);
+    WHEN ("We tim_sort by key")
+    {
+      long comparisons = 0;
+      SortUtils::tim_sort (v.begin (), v.end (),
+                           [&] (int a, int b) {
+                             ++comparisons;
+                             return a < b;
+                           },
+                           &std::pair<int, int>::first);
+      THEN ("Equal keys keep their original order")
+      {
+        REQUIRE (expected == v);
+      }
+      if (shape == 1 || shape == 2)
+      {
+        THEN ("Sorted and reversed input takes one pass")
+        {
+          REQUIRE (comparisons <= (n > 0 ? n - 1 : 0));
+        }
+      }
+    }
+  }
+}
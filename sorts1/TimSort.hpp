@@ -0,0 +1,598 @@
+#ifndef TIM_SORT_HPP_
+#define TIM_SORT_HPP_
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <utility>
+#include <vector>
+
+#include "DivideAndConquer.hpp"
+
+namespace SortUtils
+{
+
+// A sorted run of tim_sort's range: first[base, base + len)
+struct TimSortRun
+{
+  std::ptrdiff_t base;
+  std::ptrdiff_t len;
+};
+
+// Merges start galloping once one side has won this many times in a row
+constexpr std::ptrdiff_t MIN_GALLOP = 7;
+
+// Return the shortest run tim_sort builds for N elements: between
+// MERGE_SORT_RUN and 2 * MERGE_SORT_RUN, and chosen so that N / minrun
+// is a power of two or just under one, which keeps the merges balanced
+//
+inline std::ptrdiff_t
+min_run (std::ptrdiff_t N)
+{
+  std::ptrdiff_t low = 0;
+  while (N >= 2 * MERGE_SORT_RUN)
+  {
+    low |= N & 1;
+    N >>= 1;
+  }
+  return N + low;
+}
+
+// Return the length of the run starting at first[lo], never past
+// first[hi]. A strictly descending run is reversed first, so the run
+// is ascending either way; only strict descent may be reversed, or
+// equal elements would swap places
+//
+template<typename Iter, typename Less>
+std::ptrdiff_t
+count_run (Iter first, std::ptrdiff_t lo, std::ptrdiff_t hi, Less less)
+{
+  std::ptrdiff_t end = lo + 1;
+  if (end == hi)
+  {
+    return 1;
+  }
+  if (less (first[end], first[lo]))
+  {
+    for (++end; end < hi && less (first[end], first[end - 1]); ++end)
+    {
+    }
+    for (std::ptrdiff_t i = lo, j = end - 1; i < j; ++i, --j)
+    {
+      std::swap (first[i], first[j]);
+    }
+  }
+  else
+  {
+    for (++end; end < hi && !less (first[end], first[end - 1]); ++end)
+    {
+    }
+  }
+  return end - lo;
+}
+
+// Given the sorted first[0, len), return where "key" would go before
+// any element equal to it: first[k - 1] < key <= first[k]
+//
+// Searches outward from first[hint] in steps of 1, 3, 7, 15, ... and
+// then binary searches the last step, so finding a position d away
+// from the hint costs O(log d) comparisons rather than O(log len)
+//
+template<typename Iter, typename Value, typename Less>
+std::ptrdiff_t
+gallop_left (Value const& key, Iter first, std::ptrdiff_t len,
+             std::ptrdiff_t hint, Less less)
+{
+  std::ptrdiff_t lastOfs = 0;
+  std::ptrdiff_t ofs = 1;
+  if (less (first[hint], key))
+  {
+    // first[hint + lastOfs] < key <= first[hint + ofs]
+    std::ptrdiff_t const maxOfs = len - hint;
+    while (ofs < maxOfs && less (first[hint + ofs], key))
+    {
+      lastOfs = ofs;
+      ofs = 2 * ofs + 1;
+    }
+    ofs = ofs < maxOfs ? ofs : maxOfs;
+    lastOfs += hint;
+    ofs += hint;
+  }
+  else
+  {
+    // first[hint - ofs] < key <= first[hint - lastOfs]
+    std::ptrdiff_t const maxOfs = hint + 1;
+    while (ofs < maxOfs && !less (first[hint - ofs], key))
+    {
+      lastOfs = ofs;
+      ofs = 2 * ofs + 1;
+    }
+    ofs = ofs < maxOfs ? ofs : maxOfs;
+    std::ptrdiff_t const last = lastOfs;
+    lastOfs = hint - ofs;
+    ofs = hint - last;
+  }
+
+  // the answer is in (lastOfs, ofs]
+  for (++lastOfs; lastOfs < ofs; )
+  {
+    std::ptrdiff_t const mid = lastOfs + (ofs - lastOfs) / 2;
+    if (less (first[mid], key))
+    {
+      lastOfs = mid + 1;
+    }
+    else
+    {
+      ofs = mid;
+    }
+  }
+  return ofs;
+}
+
+// Like gallop_left, but return where "key" would go after any element
+// equal to it: first[k - 1] <= key < first[k]
+//
+template<typename Iter, typename Value, typename Less>
+std::ptrdiff_t
+gallop_right (Value const& key, Iter first, std::ptrdiff_t len,
+              std::ptrdiff_t hint, Less less)
+{
+  std::ptrdiff_t lastOfs = 0;
+  std::ptrdiff_t ofs = 1;
+  if (less (key, first[hint]))
+  {
+    // first[hint - ofs] <= key < first[hint - lastOfs]
+    std::ptrdiff_t const maxOfs = hint + 1;
+    while (ofs < maxOfs && less (key, first[hint - ofs]))
+    {
+      lastOfs = ofs;
+      ofs = 2 * ofs + 1;
+    }
+    ofs = ofs < maxOfs ? ofs : maxOfs;
+    std::ptrdiff_t const last = lastOfs;
+    lastOfs = hint - ofs;
+    ofs = hint - last;
+  }
+  else
+  {
+    // first[hint + lastOfs] <= key < first[hint + ofs]
+    std::ptrdiff_t const maxOfs = len - hint;
+    while (ofs < maxOfs && !less (key, first[hint + ofs]))
+    {
+      lastOfs = ofs;
+      ofs = 2 * ofs + 1;
+    }
+    ofs = ofs < maxOfs ? ofs : maxOfs;
+    lastOfs += hint;
+    ofs += hint;
+  }
+
+  // the answer is in (lastOfs, ofs]
+  for (++lastOfs; lastOfs < ofs; )
+  {
+    std::ptrdiff_t const mid = lastOfs + (ofs - lastOfs) / 2;
+    if (less (key, first[mid]))
+    {
+      ofs = mid;
+    }
+    else
+    {
+      lastOfs = mid + 1;
+    }
+  }
+  return ofs;
+}
+
+// Merge the neighbouring runs first[0, len1) and first[len1, len1 +
+// len2), with len1 <= len2, moving the first run out to "buf" and
+// filling the range from the front
+//
+// Preconditions (merge_at trims the runs to meet them):
+//   first[len1] goes before first[0], and
+//   first[len1 - 1] goes after first[len1 + len2 - 1]
+//
+// Takes one element at a time until one run has won MIN_GALLOP times
+// in a row, then gallops: finds how far the winning run keeps winning
+// with one search and moves that whole stretch at once. "minGallop"
+// carries over between merges, and shrinks while galloping pays off
+//
+template<typename Iter, typename T, typename Less>
+void
+merge_lo (Iter first, std::ptrdiff_t len1, std::ptrdiff_t len2,
+          std::vector<T>& buf, std::ptrdiff_t& minGallop, Less less)
+{
+  buf.assign (std::make_move_iterator (first),
+              std::make_move_iterator (first + len1));
+  auto const tmp = buf.begin ();
+  std::ptrdiff_t c1 = 0;     // next in tmp
+  std::ptrdiff_t c2 = len1;  // next in the second run
+  std::ptrdiff_t dest = 0;
+
+  // the first run is down to its last element, which goes last, or
+  // the second run is used up
+  auto const merge = [&] {
+    first[dest++] = std::move (first[c2++]);
+    if (--len2 == 0 || len1 == 1)
+    {
+      return;
+    }
+    for (;;)
+    {
+      std::ptrdiff_t count1 = 0;
+      std::ptrdiff_t count2 = 0;
+      do
+      {
+        if (less (first[c2], tmp[c1]))
+        {
+          first[dest++] = std::move (first[c2++]);
+          ++count2;
+          count1 = 0;
+          if (--len2 == 0)
+          {
+            return;
+          }
+        }
+        else
+        {
+          first[dest++] = std::move (tmp[c1++]);
+          ++count1;
+          count2 = 0;
+          if (--len1 == 1)
+          {
+            return;
+          }
+        }
+      } while (count1 < minGallop && count2 < minGallop);
+
+      do
+      {
+        count1 = SortUtils::gallop_right (first[c2], tmp + c1, len1, 0, less);
+        if (count1 != 0)
+        {
+          std::copy (std::make_move_iterator (tmp + c1),
+                     std::make_move_iterator (tmp + c1 + count1), first + dest);
+          dest += count1;
+          c1 += count1;
+          len1 -= count1;
+          if (len1 <= 1)
+          {
+            return;
+          }
+        }
+        first[dest++] = std::move (first[c2++]);
+        if (--len2 == 0)
+        {
+          return;
+        }
+
+        count2 = SortUtils::gallop_left (tmp[c1], first + c2, len2, 0, less);
+        if (count2 != 0)
+        {
+          // dest is behind c2, so moving forward is safe
+          std::copy (std::make_move_iterator (first + c2),
+                     std::make_move_iterator (first + c2 + count2),
+                     first + dest);
+          dest += count2;
+          c2 += count2;
+          len2 -= count2;
+          if (len2 == 0)
+          {
+            return;
+          }
+        }
+        first[dest++] = std::move (tmp[c1++]);
+        if (--len1 == 1)
+        {
+          return;
+        }
+        --minGallop;
+      } while (count1 >= MIN_GALLOP || count2 >= MIN_GALLOP);
+      // galloping stopped paying off: make it harder to start again
+      minGallop = (minGallop < 0 ? 0 : minGallop) + 2;
+    }
+  };
+  merge ();
+
+  if (len1 == 1)
+  {
+    std::copy (std::make_move_iterator (first + c2),
+               std::make_move_iterator (first + c2 + len2), first + dest);
+    first[dest + len2] = std::move (tmp[c1]);
+  }
+  else
+  {
+    std::copy (std::make_move_iterator (tmp + c1),
+               std::make_move_iterator (tmp + c1 + len1), first + dest);
+  }
+}
+
+// Move first[from, from + n) to first[to, to + n), for to > from
+//
+template<typename Iter>
+void
+move_up (Iter first, std::ptrdiff_t from, std::ptrdiff_t to, std::ptrdiff_t n)
+{
+  for (std::ptrdiff_t i = n; i-- > 0; )
+  {
+    first[to + i] = std::move (first[from + i]);
+  }
+}
+
+// The mirror image of merge_lo, for len1 > len2: the second run moves
+// out to "buf" and the range fills from the back
+//
+template<typename Iter, typename T, typename Less>
+void
+merge_hi (Iter first, std::ptrdiff_t len1, std::ptrdiff_t len2,
+          std::vector<T>& buf, std::ptrdiff_t& minGallop, Less less)
+{
+  buf.assign (std::make_move_iterator (first + len1),
+              std::make_move_iterator (first + len1 + len2));
+  auto const tmp = buf.begin ();
+  std::ptrdiff_t c1 = len1 - 1;  // last left in the first run
+  std::ptrdiff_t c2 = len2 - 1;  // last left in tmp
+  std::ptrdiff_t dest = len1 + len2 - 1;
+
+  // the second run is down to its first element, which goes first, or
+  // the first run is used up
+  auto const merge = [&] {
+    first[dest--] = std::move (first[c1--]);
+    if (--len1 == 0 || len2 == 1)
+    {
+      return;
+    }
+    for (;;)
+    {
+      std::ptrdiff_t count1 = 0;
+      std::ptrdiff_t count2 = 0;
+      do
+      {
+        if (less (tmp[c2], first[c1]))
+        {
+          first[dest--] = std::move (first[c1--]);
+          ++count1;
+          count2 = 0;
+          if (--len1 == 0)
+          {
+            return;
+          }
+        }
+        else
+        {
+          first[dest--] = std::move (tmp[c2--]);
+          ++count2;
+          count1 = 0;
+          if (--len2 == 1)
+          {
+            return;
+          }
+        }
+      } while (count1 < minGallop && count2 < minGallop);
+
+      do
+      {
+        count1 = len1 - SortUtils::gallop_right (tmp[c2], first, len1,
+                                                 len1 - 1, less);
+        if (count1 != 0)
+        {
+          dest -= count1;
+          c1 -= count1;
+          len1 -= count1;
+          SortUtils::move_up (first, c1 + 1, dest + 1, count1);
+          if (len1 == 0)
+          {
+            return;
+          }
+        }
+        first[dest--] = std::move (tmp[c2--]);
+        if (--len2 == 1)
+        {
+          return;
+        }
+
+        count2 = len2 - SortUtils::gallop_left (first[c1], tmp, len2,
+                                                len2 - 1, less);
+        if (count2 != 0)
+        {
+          dest -= count2;
+          c2 -= count2;
+          len2 -= count2;
+          std::copy (std::make_move_iterator (tmp + c2 + 1),
+                     std::make_move_iterator (tmp + c2 + 1 + count2),
+                     first + dest + 1);
+          if (len2 <= 1)
+          {
+            return;
+          }
+        }
+        first[dest--] = std::move (first[c1--]);
+        if (--len1 == 0)
+        {
+          return;
+        }
+        --minGallop;
+      } while (count1 >= MIN_GALLOP || count2 >= MIN_GALLOP);
+      minGallop = (minGallop < 0 ? 0 : minGallop) + 2;
+    }
+  };
+  merge ();
+
+  if (len2 == 1)
+  {
+    dest -= len1;
+    c1 -= len1;
+    SortUtils::move_up (first, c1 + 1, dest + 1, len1);
+    first[dest] = std::move (tmp[c2]);
+  }
+  else
+  {
+    std::copy (std::make_move_iterator (tmp),
+               std::make_move_iterator (tmp + len2), first + dest - (len2 - 1));
+  }
+}
+
+// Merge runs[i] with runs[i + 1] and drop the latter from the stack
+//
+// Before merging, elements of the first run that already go before
+// all of the second, and elements of the second that go after all of
+// the first, are left where they are, so runs that barely overlap
+// cost a couple of gallops rather than a merge
+//
+template<typename Iter, typename T, typename Less>
+void
+merge_at (Iter first, std::vector<TimSortRun>& runs, std::size_t i,
+          std::vector<T>& buf, std::ptrdiff_t& minGallop, Less less)
+{
+  std::ptrdiff_t base1 = runs[i].base;
+  std::ptrdiff_t len1 = runs[i].len;
+  std::ptrdiff_t const base2 = runs[i + 1].base;
+  std::ptrdiff_t len2 = runs[i + 1].len;
+  runs[i].len = len1 + len2;
+  if (i + 3 == runs.size ())
+  {
+    runs[i + 1] = runs[i + 2];
+  }
+  runs.pop_back ();
+
+  std::ptrdiff_t const k = SortUtils::gallop_right (first[base2], first + base1,
+                                                    len1, 0, less);
+  base1 += k;
+  len1 -= k;
+  if (len1 == 0)
+  {
+    return;
+  }
+  len2 = SortUtils::gallop_left (first[base1 + len1 - 1], first + base2, len2,
+                                 len2 - 1, less);
+  if (len2 == 0)
+  {
+    return;
+  }
+
+  if (len1 <= len2)
+  {
+    SortUtils::merge_lo (first + base1, len1, len2, buf, minGallop, less);
+  }
+  else
+  {
+    SortUtils::merge_hi (first + base1, len1, len2, buf, minGallop, less);
+  }
+}
+
+// Merge runs on top of the stack until, reading down from the top,
+// each run is shorter than the one below and each is shorter than the
+// two above it together. The lengths then grow at least as fast as the
+// Fibonacci numbers, so the stack holds O(log N) runs and every merge
+// is between runs of similar length
+//
+template<typename Iter, typename T, typename Less>
+void
+merge_collapse (Iter first, std::vector<TimSortRun>& runs,
+                std::vector<T>& buf, std::ptrdiff_t& minGallop, Less less)
+{
+  while (runs.size () > 1)
+  {
+    std::size_t n = runs.size () - 2;
+    if ((n > 0 && runs[n - 1].len <= runs[n].len + runs[n + 1].len)
+        || (n > 1 && runs[n - 2].len <= runs[n - 1].len + runs[n].len))
+    {
+      if (runs[n - 1].len < runs[n + 1].len)
+      {
+        --n;
+      }
+    }
+    else if (runs[n].len > runs[n + 1].len)
+    {
+      break;
+    }
+    SortUtils::merge_at (first, runs, n, buf, minGallop, less);
+  }
+}
+
+// Extend the sorted first[0, sorted) to a sorted first[0, N) by binary
+// insertion: each new element is placed after the equal ones already
+// there (upper_bound), which keeps it stable. Costs about log2 (i)
+// comparisons for the i-th element; the moves stay quadratic, but
+// only over a run of at most 2 * MERGE_SORT_RUN elements
+//
+template<typename Iter, typename Compare, typename Proj>
+void
+binary_insertion_sort (Iter first, std::ptrdiff_t sorted, std::ptrdiff_t N,
+                       Compare comp, Proj proj)
+{
+  using T = typename std::iterator_traits<Iter>::value_type;
+
+  for (std::ptrdiff_t i = sorted; i < N; ++i)
+  {
+    Iter const pos = std::upper_bound (
+      first, first + i, std::invoke (proj, first[i]),
+      [&] (auto const& key, auto const& x) {
+        return comp (key, std::invoke (proj, x));
+      });
+    T tmp = std::move (first[i]);
+    std::move_backward (pos, first + i, first + i + 1);
+    *pos = std::move (tmp);
+  }
+}
+
+// Given a RandomAccessRange, sort using an adaptive, stable merge sort
+// (TimSort)
+//
+// Instead of splitting at the midpoint, finds the runs already in the
+// data: each ascending or strictly descending stretch (the latter is
+// reversed) becomes a run, and runs shorter than min_run are extended
+// by binary insertion. Runs are merged as they are found, keeping the
+// stack balanced, with galloping merges that move long stretches at a
+// time. Sorted or reversed input costs N - 1 comparisons, data made of
+// k runs costs O(N log k), and random data costs O(N log N) as with
+// merge_sort. Allocates at most N / 2 elements of scratch space
+//
+template<typename Iter, typename Compare = std::less<>, typename Proj = identity>
+void
+tim_sort (Iter first, Iter last, Compare comp = {}, Proj proj = {})
+{
+  using T = typename std::iterator_traits<Iter>::value_type;
+
+  const std::ptrdiff_t N = std::distance (first, last);
+  if (N < 2)
+  {
+    return;
+  }
+  auto const less = [&] (auto const& a, auto const& b) {
+    return comp (std::invoke (proj, a), std::invoke (proj, b));
+  };
+
+  std::ptrdiff_t const minRun = SortUtils::min_run (N);
+  std::vector<TimSortRun> runs;
+  std::vector<T> buf;
+  std::ptrdiff_t minGallop = MIN_GALLOP;
+  for (std::ptrdiff_t lo = 0; lo < N; )
+  {
+    std::ptrdiff_t len = SortUtils::count_run (first, lo, N, less);
+    if (len < minRun)
+    {
+      // the natural run is already sorted: insert only the new elements
+      std::ptrdiff_t const runLen = len;
+      len = N - lo < minRun ? N - lo : minRun;
+      SortUtils::binary_insertion_sort (first + lo, runLen, len, comp, proj);
+    }
+    runs.push_back ({ lo, len });
+    SortUtils::merge_collapse (first, runs, buf, minGallop, less);
+    lo += len;
+  }
+
+  while (runs.size () > 1)
+  {
+    std::size_t n = runs.size () - 2;
+    if (n > 0 && runs[n - 1].len < runs[n + 1].len)
+    {
+      --n;
+    }
+    SortUtils::merge_at (first, runs, n, buf, minGallop, less);
+  }
+}
+
+} // end namespace SortUtils
+
+#endif
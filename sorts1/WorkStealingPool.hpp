@@ -0,0 +1,447 @@
+#ifndef WORK_STEALING_POOL_HPP_
+#define WORK_STEALING_POOL_HPP_
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace SortUtils
+{
+
+// A fixed set of threads for fork-join parallelism
+//
+// Every worker owns a queue of tasks. A worker pushes the tasks it
+// spawns onto the back of its own queue and pops from the back (the
+// newest, smallest pieces of work, still hot in cache); an idle worker
+// steals from the front of someone else's queue (the oldest, largest
+// pieces)
+//
+// A pool of size N runs N - 1 worker threads: the thread waiting on a
+// TaskGroup works too, so it is the N-th, and queue 0 is its own. A
+// pool of size 1 runs everything on the calling thread
+//
+// The queues are Chase-Lev deques: the owner pushes and pops its own
+// end without a lock, and thieves take the other end with one CAS.
+// Queue 0 may be used by any thread outside the pool, so its owner
+// side is serialized by a mutex; stealing from it stays lock-free
+//
+// Idle threads spin briefly, then sleep on a condition variable.
+// Submitting a task only locks and notifies when someone sleeps
+//
+class WorkStealingPool
+{
+public:
+  explicit WorkStealingPool (unsigned size = std::thread::hardware_concurrency ())
+    : m_size (size == 0 ? 1 : size)
+  {
+    for (unsigned i = 0; i < m_size; ++i)
+    {
+      m_queues.push_back (std::make_unique<Queue> ());
+    }
+    for (unsigned i = 1; i < m_size; ++i)
+    {
+      m_threads.emplace_back ([this, i] { work (i); });
+    }
+  }
+
+  WorkStealingPool (WorkStealingPool const&) = delete;
+  WorkStealingPool& operator= (WorkStealingPool const&) = delete;
+
+  // finishes every queued task, then joins the workers
+  ~WorkStealingPool ()
+  {
+    {
+      std::lock_guard<std::mutex> lock (m_sleepMutex);
+      m_stop = true;
+    }
+    m_wake.notify_all ();
+    for (std::thread& t : m_threads)
+    {
+      t.join ();
+    }
+  }
+
+  // number of threads that run tasks, counting the waiting thread
+  unsigned
+  size () const
+  {
+    return m_size;
+  }
+
+  void
+  submit (std::function<void ()> task)
+  {
+    std::size_t const index = home ();
+    // count the task before it can be taken, so the count never
+    // drops below the number of tasks really queued
+    m_queued.fetch_add (1);
+    Queue& q = *m_queues[index];
+    if (owns (index))
+    {
+      q.push (new Task (std::move (task)));
+    }
+    else
+    {
+      std::lock_guard<std::mutex> lock (q.ownerMutex);
+      q.push (new Task (std::move (task)));
+    }
+    // a sleeper counts itself before it checks m_queued, and we
+    // counted the task before checking m_sleepers, so one of us sees
+    // the other (both are seq_cst)
+    if (m_sleepers.load () != 0)
+    {
+      std::lock_guard<std::mutex> lock (m_sleepMutex);
+      m_wake.notify_one ();
+    }
+  }
+
+  // runs one queued task, if there is one -- returns whether it did
+  bool
+  run_one ()
+  {
+    std::size_t const self = home ();
+    // our own newest task first, then the oldest task of each other queue
+    Task* task = nullptr;
+    if (owns (self))
+    {
+      task = m_queues[self]->take ();
+    }
+    else
+    {
+      std::lock_guard<std::mutex> lock (m_queues[self]->ownerMutex);
+      task = m_queues[self]->take ();
+    }
+    for (std::size_t k = 1; k < m_queues.size () && !task; ++k)
+    {
+      task = m_queues[(self + k) % m_queues.size ()]->steal ();
+    }
+    if (!task)
+    {
+      return false;
+    }
+    m_queued.fetch_sub (1, std::memory_order_relaxed);
+    std::unique_ptr<Task> const owned (task);
+    (*owned) ();
+    return true;
+  }
+
+  // runs queued tasks until "done ()" is true; with none to run it
+  //   spins a little, then sleeps until a task is queued or someone
+  //   calls notify_waiters
+  template<typename Done>
+  void
+  run_until (Done done)
+  {
+    unsigned spins = 0;
+    while (!done ())
+    {
+      if (run_one ())
+      {
+        spins = 0;
+      }
+      else if (++spins < SPINS)
+      {
+        std::this_thread::yield ();
+      }
+      else
+      {
+        sleep ([&] { return done (); });
+        spins = 0;
+      }
+    }
+  }
+
+  // wakes the threads sleeping in run_until, so they check "done"
+  //   again. Call it after making some waiter's "done" true
+  void
+  notify_waiters ()
+  {
+    if (m_sleepers.load () != 0)
+    {
+      std::lock_guard<std::mutex> lock (m_sleepMutex);
+      m_wake.notify_all ();
+    }
+  }
+
+private:
+  using Task = std::function<void ()>;
+
+  // times an idle thread looks for work before it sleeps
+  static constexpr unsigned SPINS = 64;
+
+  // Chase-Lev deque of tasks ("Correct and Efficient Work-Stealing
+  // for Weak Memory Models", Le et al., 2013). push and take are for
+  // the owner only; steal may run on any thread at the same time.
+  // The slots are atomic so a thief reading a stale slot is harmless:
+  // its CAS on m_top then fails. Outgrown rings are kept until the
+  // queue dies, since a thief may still be reading one
+  struct Queue
+  {
+    struct Ring
+    {
+      explicit Ring (std::int64_t capacity)
+        : mask (capacity - 1), slots (new std::atomic<Task*>[capacity])
+      {
+      }
+
+      std::atomic<Task*>&
+      operator[] (std::int64_t i)
+      {
+        return slots[i & mask];
+      }
+
+      std::int64_t mask;
+      std::unique_ptr<std::atomic<Task*>[]> slots;
+    };
+
+    Queue ()
+    {
+      m_rings.push_back (std::make_unique<Ring> (256));
+      m_ring.store (m_rings.back ().get (), std::memory_order_relaxed);
+    }
+
+    // deletes the tasks nobody ran
+    ~Queue ()
+    {
+      Ring& ring = *m_ring.load (std::memory_order_relaxed);
+      for (std::int64_t i = m_top.load (); i < m_bottom.load (); ++i)
+      {
+        delete ring[i].load (std::memory_order_relaxed);
+      }
+    }
+
+    void
+    push (Task* task)
+    {
+      std::int64_t const b = m_bottom.load (std::memory_order_relaxed);
+      std::int64_t const t = m_top.load (std::memory_order_acquire);
+      Ring* ring = m_ring.load (std::memory_order_relaxed);
+      if (b - t > ring->mask)
+      {
+        ring = grow (*ring, t, b);
+      }
+      // release: a thief that reads the slot sees the whole task
+      (*ring)[b].store (task, std::memory_order_release);
+      m_bottom.store (b + 1, std::memory_order_release);
+    }
+
+    // the newest task, or nullptr
+    Task*
+    take ()
+    {
+      std::int64_t const b = m_bottom.load (std::memory_order_relaxed) - 1;
+      Ring& ring = *m_ring.load (std::memory_order_relaxed);
+      // seq_cst store then load: a thief must either see the smaller
+      // bottom or have moved top before we read it
+      m_bottom.store (b);
+      std::int64_t t = m_top.load ();
+      if (t > b)
+      {
+        m_bottom.store (b + 1, std::memory_order_relaxed);
+        return nullptr;
+      }
+      Task* task = ring[b].load (std::memory_order_relaxed);
+      if (t == b)
+      {
+        // the last task: race the thieves for it
+        if (!m_top.compare_exchange_strong (t, t + 1))
+        {
+          task = nullptr;
+        }
+        m_bottom.store (b + 1, std::memory_order_relaxed);
+      }
+      return task;
+    }
+
+    // the oldest task, or nullptr if there is none or we lost a race
+    Task*
+    steal ()
+    {
+      std::int64_t t = m_top.load ();
+      std::int64_t const b = m_bottom.load ();
+      if (t >= b)
+      {
+        return nullptr;
+      }
+      Task* task = (*m_ring.load (std::memory_order_acquire))[t].load (
+        std::memory_order_acquire);
+      if (!m_top.compare_exchange_strong (t, t + 1))
+      {
+        return nullptr;
+      }
+      return task;
+    }
+
+    Ring*
+    grow (Ring& old, std::int64_t t, std::int64_t b)
+    {
+      m_rings.push_back (std::make_unique<Ring> (2 * (old.mask + 1)));
+      Ring* ring = m_rings.back ().get ();
+      for (std::int64_t i = t; i < b; ++i)
+      {
+        (*ring)[i].store (old[i].load (std::memory_order_relaxed),
+                          std::memory_order_release);
+      }
+      m_ring.store (ring, std::memory_order_release);
+      return ring;
+    }
+
+    // taken by the owner side of queue 0 only (see owns)
+    std::mutex ownerMutex;
+
+    std::atomic<std::int64_t> m_top{0};
+    std::atomic<std::int64_t> m_bottom{0};
+    std::atomic<Ring*> m_ring{nullptr};
+    std::vector<std::unique_ptr<Ring>> m_rings;
+  };
+
+  // which pool (if any) the calling thread works for, and its queue
+  struct Worker
+  {
+    WorkStealingPool const* pool = nullptr;
+    std::size_t index = 0;
+  };
+
+  static Worker&
+  current ()
+  {
+    static thread_local Worker worker;
+    return worker;
+  }
+
+  // the calling thread's queue: its own if it is one of our workers,
+  //   queue 0 otherwise
+  std::size_t
+  home () const
+  {
+    Worker const& self = current ();
+    return self.pool == this ? self.index : 0;
+  }
+
+  // whether the calling thread is the only owner of queue "index":
+  //   every queue but 0 belongs to one worker, while queue 0 is shared
+  //   by every thread outside the pool
+  static bool
+  owns (std::size_t index)
+  {
+    return index != 0;
+  }
+
+  // blocks until a task is queued, the pool stops or "ready ()" is true
+  template<typename Ready>
+  void
+  sleep (Ready ready)
+  {
+    std::unique_lock<std::mutex> lock (m_sleepMutex);
+    m_sleepers.fetch_add (1);
+    m_wake.wait (lock, [&] {
+      return m_stop || m_queued.load () != 0 || ready ();
+    });
+    m_sleepers.fetch_sub (1);
+  }
+
+  void
+  work (std::size_t index)
+  {
+    current () = {this, index};
+    run_until ([this] { return m_stop.load () && m_queued.load () == 0; });
+  }
+
+  unsigned m_size;
+  std::vector<std::unique_ptr<Queue>> m_queues;
+  std::vector<std::thread> m_threads;
+
+  // m_queued counts tasks in all the queues and m_sleepers the threads
+  // waiting on m_wake; a sleeper wakes once m_queued is non-zero
+  std::mutex m_sleepMutex;
+  std::condition_variable m_wake;
+  std::atomic<std::size_t> m_queued{0};
+  std::atomic<unsigned> m_sleepers{0};
+  // set under m_sleepMutex, so a sleeper cannot miss it
+  std::atomic<bool> m_stop{false};
+};
+
+// A set of tasks run on a WorkStealingPool that can be waited for
+//
+// wait () runs queued tasks itself, so tasks may spawn and wait on
+// their own groups without tying up a thread; when there is nothing to
+// run it sleeps until the group is done. The first exception thrown by
+// a task is rethrown by wait ()
+//
+class TaskGroup
+{
+public:
+  explicit TaskGroup (WorkStealingPool& pool)
+    : m_pool (pool)
+  {
+  }
+
+  TaskGroup (TaskGroup const&) = delete;
+  TaskGroup& operator= (TaskGroup const&) = delete;
+
+  ~TaskGroup ()
+  {
+    try
+    {
+      wait ();
+    }
+    catch (...)
+    {
+    }
+  }
+
+  template<typename F>
+  void
+  run (F task)
+  {
+    m_pending.fetch_add (1, std::memory_order_relaxed);
+    m_pool.submit ([this, task] () mutable {
+      try
+      {
+        task ();
+      }
+      catch (...)
+      {
+        std::lock_guard<std::mutex> lock (m_errorMutex);
+        if (!m_error)
+        {
+          m_error = std::current_exception ();
+        }
+      }
+      // once the count is 0 the group may be gone, so keep the pool
+      WorkStealingPool& pool = m_pool;
+      if (m_pending.fetch_sub (1) == 1)
+      {
+        pool.notify_waiters ();
+      }
+    });
+  }
+
+  void
+  wait ()
+  {
+    m_pool.run_until ([this] { return m_pending.load () == 0; });
+    if (m_error)
+    {
+      std::rethrow_exception (std::exchange (m_error, nullptr));
+    }
+  }
+
+private:
+  WorkStealingPool& m_pool;
+  std::atomic<std::size_t> m_pending{0};
+  std::mutex m_errorMutex;
+  std::exception_ptr m_error;
+};
+
+} // end namespace SortUtils
+
+#endif
@@ -3,6 +3,8 @@
     Author: Joshua Carney
     Course: 362-f20
     Description: an integer vector class with random access and dynamic resizing
+                 plus vectorized numeric kernels (dot product, prefix sum,
+                 min/max) that use AVX2 or AVX-512 when the CPU has them
 */
 
 /*********************************************/
@@ -12,6 +14,181 @@
 #include <algorithm>
 #include <cstdlib>
 #include <iterator>
+#include <stdexcept>
+#include <utility>
+
+#include "../common/SimdIsa.hpp"
+#include "../array/Array/ArraySimd.hpp"
+/*********************************************/
+
+//kernels behind Vect's numeric member functions
+//each one works on the range [p, p + n); the instruction set is the shared
+//one in SimdIsa.hpp, so SimdIsa::set_isa restricts these kernels too
+namespace VectSimd {
+    using SimdIsa::Isa;
+
+    //integer arithmetic is done unsigned so overflow wraps instead of being undefined
+    inline long long dotScalar(const int* a, const int* b, size_t n) {
+        unsigned long long sum = 0;
+        for (size_t i = 0; i < n; ++i)
+            sum += static_cast<unsigned long long>(static_cast<long long>(a[i]) * b[i]);
+        return static_cast<long long>(sum);
+    }
+
+    inline void prefixSumScalar(int* p, size_t n, int carry = 0) {
+        unsigned sum = static_cast<unsigned>(carry);
+        for (size_t i = 0; i < n; ++i) {
+            sum += static_cast<unsigned>(p[i]);
+            p[i] = static_cast<int>(sum);
+        }
+    }
+
+#if SIMD_ISA_X86
+    /*********************************************/
+    //AVX2, 8 lanes
+
+#define VECT_AVX2 __attribute__((target("avx2")))
+
+    //products are taken in 64 bits: each half of the load is sign extended
+    //to 4 64-bit lanes and _mm256_mul_epi32 multiplies their low halves
+    VECT_AVX2 inline long long dotAvx2(const int* a, const int* b, size_t n) {
+        __m256i sum = _mm256_setzero_si256();
+        size_t i = 0;
+        for (; i + 8 <= n; i += 8) {
+            __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+            __m256i y = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i));
+            __m256i xlo = _mm256_cvtepi32_epi64(_mm256_castsi256_si128(x));
+            __m256i xhi = _mm256_cvtepi32_epi64(_mm256_extracti128_si256(x, 1));
+            __m256i ylo = _mm256_cvtepi32_epi64(_mm256_castsi256_si128(y));
+            __m256i yhi = _mm256_cvtepi32_epi64(_mm256_extracti128_si256(y, 1));
+            sum = _mm256_add_epi64(sum, _mm256_mul_epi32(xlo, ylo));
+            sum = _mm256_add_epi64(sum, _mm256_mul_epi32(xhi, yhi));
+        }
+        alignas(32) unsigned long long lanes[4];
+        _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), sum);
+        unsigned long long result = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+        return static_cast<long long>(result + dotScalar(a + i, b + i, n - i));
+    }
+
+    //scan each 128-bit half with two shift-adds, add the low half's total to
+    //the high half, then add the running total of everything before
+    VECT_AVX2 inline void prefixSumAvx2(int* p, size_t n) {
+        const __m256i lowTotal = _mm256_setr_epi32(0, 0, 0, 0, 3, 3, 3, 3);
+        const __m256i last = _mm256_set1_epi32(7);
+        __m256i carry = _mm256_setzero_si256();
+        size_t i = 0;
+        for (; i + 8 <= n; i += 8) {
+            __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + i));
+            x = _mm256_add_epi32(x, _mm256_slli_si256(x, 4));
+            x = _mm256_add_epi32(x, _mm256_slli_si256(x, 8));
+            __m256i low = _mm256_permutevar8x32_epi32(x, lowTotal);
+            x = _mm256_add_epi32(x, _mm256_blend_epi32(_mm256_setzero_si256(), low, 0xF0));
+            x = _mm256_add_epi32(x, carry);
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(p + i), x);
+            carry = _mm256_permutevar8x32_epi32(x, last);
+        }
+        prefixSumScalar(p + i, n - i, _mm256_extract_epi32(carry, 0));
+    }
+
+#undef VECT_AVX2
+
+    /*********************************************/
+    //AVX-512, 16 lanes, tails use masked loads and stores
+
+SIMD_ISA_AVX512_BEGIN
+
+#define VECT_AVX512 __attribute__((target("avx512f")))
+
+    VECT_AVX512 inline __m512i dotStep512(__m512i sum, __m512i x, __m512i y) {
+        __m512i xlo = _mm512_cvtepi32_epi64(_mm512_castsi512_si256(x));
+        __m512i xhi = _mm512_cvtepi32_epi64(_mm512_extracti64x4_epi64(x, 1));
+        __m512i ylo = _mm512_cvtepi32_epi64(_mm512_castsi512_si256(y));
+        __m512i yhi = _mm512_cvtepi32_epi64(_mm512_extracti64x4_epi64(y, 1));
+        sum = _mm512_add_epi64(sum, _mm512_mul_epi32(xlo, ylo));
+        return _mm512_add_epi64(sum, _mm512_mul_epi32(xhi, yhi));
+    }
+
+    VECT_AVX512 inline long long dotAvx512(const int* a, const int* b, size_t n) {
+        __m512i sum = _mm512_setzero_si512();
+        size_t i = 0;
+        for (; i + 16 <= n; i += 16)
+            sum = dotStep512(sum, _mm512_loadu_si512(a + i), _mm512_loadu_si512(b + i));
+        __mmask16 tail = ArraySimd::tail_mask(n - i);
+        sum = dotStep512(sum, _mm512_maskz_loadu_epi32(tail, a + i),
+                         _mm512_maskz_loadu_epi32(tail, b + i));
+        //reduce unsigned, _mm512_reduce_add_epi64 would overflow a signed long long
+        alignas(64) unsigned long long lanes[8];
+        _mm512_store_si512(lanes, sum);
+        unsigned long long result = 0;
+        for (unsigned long long l : lanes)
+            result += l;
+        return static_cast<long long>(result);
+    }
+
+    //log-step scan: lane j adds lane j - k for k = 1, 2, 4, 8
+    VECT_AVX512 inline __m512i scan512(__m512i x) {
+        const __m512i iota = _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+        for (int k = 1; k < 16; k *= 2) {
+            __m512i from = _mm512_sub_epi32(iota, _mm512_set1_epi32(k));
+            __mmask16 lanes = static_cast<__mmask16>(0xFFFFu << k);
+            x = _mm512_add_epi32(x, _mm512_maskz_permutexvar_epi32(lanes, from, x));
+        }
+        return x;
+    }
+
+    VECT_AVX512 inline void prefixSumAvx512(int* p, size_t n) {
+        const __m512i last = _mm512_set1_epi32(15);
+        __m512i carry = _mm512_setzero_si512();
+        size_t i = 0;
+        for (; i + 16 <= n; i += 16) {
+            __m512i x = _mm512_add_epi32(scan512(_mm512_loadu_si512(p + i)), carry);
+            _mm512_storeu_si512(p + i, x);
+            carry = _mm512_permutexvar_epi32(last, x);
+        }
+        __mmask16 tail = ArraySimd::tail_mask(n - i);
+        __m512i x = _mm512_add_epi32(scan512(_mm512_maskz_loadu_epi32(tail, p + i)), carry);
+        _mm512_mask_storeu_epi32(p + i, tail, x);
+    }
+
+#undef VECT_AVX512
+SIMD_ISA_AVX512_END
+#endif
+
+    /*********************************************/
+    //dispatch on the active instruction set
+
+    inline long long dot(const int* a, const int* b, size_t n) {
+#if SIMD_ISA_X86
+        switch (SimdIsa::active_isa()) {
+            case Isa::Avx512: return dotAvx512(a, b, n);
+            case Isa::Avx2: return dotAvx2(a, b, n);
+            default: break;
+        }
+#endif
+        return dotScalar(a, b, n);
+    }
+
+    inline void prefixSum(int* p, size_t n) {
+#if SIMD_ISA_X86
+        switch (SimdIsa::active_isa()) {
+            case Isa::Avx512: prefixSumAvx512(p, n); return;
+            case Isa::Avx2: prefixSumAvx2(p, n); return;
+            default: break;
+        }
+#endif
+        prefixSumScalar(p, n);
+    }
+
+    //min and max need n > 0, ArraySimd already has kernels for them
+    inline int min(const int* p, size_t n) {
+        return ArraySimd::min(p, n);
+    }
+
+    inline int max(const int* p, size_t n) {
+        return ArraySimd::max(p, n);
+    }
+}
+
 /*********************************************/
 
 class Vect {
@@ -25,27 +202,51 @@ class Vect {
         using iterator = int*; //iterators are just integer pointers
         //const_iterators are read only iterators
         //std::vector<int>::const_iterator iter2 = v3.begin();
-        //*iter2 = 15 is illegal, 
+        //*iter2 = 15 is illegal,
         using const_iterator = const int*;
 
         //constructors
         //default constructor
         // member initializer list
-        Vect(): size(0), capacity(0), vect(nullptr) { //doing this is more efficient as opposed to the normal way, the compiler starts at a random number before the first line, then assigns our values otherwise
+        Vect(): vect(nullptr), size(0), capacity(0) { //doing this is more efficient as opposed to the normal way, the compiler starts at a random number before the first line, then assigns our values otherwise
 
         }
 
-        Vect(unsigned size): size(size), capacity(size), vect(new int[size]) {
+        //the () value-initializes, so every element starts at 0
+        explicit Vect(unsigned size): vect(size == 0 ? nullptr : new int[size]()), size(size), capacity(size) {
 
         }
 
-        Vect(unsigned size, const int& value): size(size), capacity(size), vect(new int[size]) {
+        Vect(unsigned size, const int& value): Vect(size) {
             std::fill(begin(), end(), value);
         }
 
+        //copy constructor, the copy only gets as much room as it needs
+        Vect(const Vect& v): Vect(v.size) {
+            std::copy(v.begin(), v.end(), begin());
+        }
+
+        //move constructor, takes v's array and leaves v empty
+        Vect(Vect&& v) noexcept: Vect() {
+            swap(v);
+        }
+
         //Destructor
         ~Vect() {
-            //delete array vect
+            delete[] vect; //delete array vect
+        }
+
+        //one assignment operator for both copy and move: "v" was already
+        //copied or moved into, so just trade arrays with it (copy-and-swap)
+        Vect& operator=(Vect v) noexcept {
+            swap(v);
+            return *this;
+        }
+
+        void swap(Vect& v) noexcept {
+            std::swap(vect, v.vect);
+            std::swap(size, v.size);
+            std::swap(capacity, v.capacity);
         }
 
         //size member functions
@@ -53,15 +254,120 @@ class Vect {
             return size;
         }
 
-        bool empty() {
-            return true;
+        bool empty() const {
+            return size == 0;
         }
 
         unsigned vectCapacity() const {
             return capacity;
         }
 
-        
+        //element access, operator[] is unchecked and at() throws
+        int& operator[](unsigned index) {
+            return vect[index];
+        }
+
+        const int& operator[](unsigned index) const {
+            return vect[index];
+        }
+
+        int& at(unsigned index) {
+            checkIndex(index);
+            return vect[index];
+        }
+
+        const int& at(unsigned index) const {
+            checkIndex(index);
+            return vect[index];
+        }
+
+        int& front() {
+            return vect[0];
+        }
+
+        const int& front() const {
+            return vect[0];
+        }
+
+        int& back() {
+            return vect[size - 1];
+        }
+
+        const int& back() const {
+            return vect[size - 1];
+        }
+
+        int* data() {
+            return vect;
+        }
+
+        const int* data() const {
+            return vect;
+        }
+
+        //modifiers
+        //the capacity doubles when full, so push_back is amortized O(1)
+        void push_back(int value) {
+            if (size == capacity)
+                reserve(capacity == 0 ? 1 : 2 * capacity);
+            vect[size++] = value;
+        }
+
+        void pop_back() {
+            if (size != 0)
+                --size;
+        }
+
+        //only ever grows the capacity, the size stays the same
+        void reserve(unsigned space) {
+            if (space <= capacity)
+                return;
+            int* bigger = new int[space];
+            std::copy(begin(), end(), bigger);
+            delete[] vect;
+            vect = bigger;
+            capacity = space;
+        }
+
+        //new elements get "value", extra elements are dropped
+        void resize(unsigned newSize, int value = 0) {
+            reserve(newSize);
+            if (newSize > size)
+                std::fill(end(), begin() + newSize, value);
+            size = newSize;
+        }
+
+        //the capacity is kept
+        void clear() {
+            size = 0;
+        }
+
+        //numeric kernels, see VectSimd above
+        //dot product in 64 bits, v must be the same size as this vector
+        long long dot(const Vect& v) const {
+            if (v.size != size)
+                throw std::invalid_argument("Vect::dot: sizes differ");
+            return VectSimd::dot(vect, v.vect, size);
+        }
+
+        //replace each element with the sum of it and everything before it
+        //int overflow wraps around
+        void prefixSum() {
+            VectSimd::prefixSum(vect, size);
+        }
+
+        //smallest and largest element, the vector must not be empty
+        int min() const {
+            checkNotEmpty("Vect::min: empty vector");
+            return VectSimd::min(vect, size);
+        }
+
+        int max() const {
+            checkNotEmpty("Vect::max: empty vector");
+            return VectSimd::max(vect, size);
+        }
+
+
         iterator begin() {
             return vect; //array name is a pointer to the first element
         }
@@ -77,5 +383,16 @@ class Vect {
         const_iterator end() const {
             return vect + size;
         }
+
+    private:
+        void checkIndex(unsigned index) const {
+            if (index >= size)
+                throw std::out_of_range("Vect::at: index out of range");
+        }
+
+        void checkNotEmpty(const char* what) const {
+            if (size == 0)
+                throw std::out_of_range(what);
+        }
 };
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,215 @@
+/*
+    Filename: VectDriver.cc
+    Author: Joshua Carney
+    Course: 362-f20
+    Description: checks Vect's growth, copies and moves, and compares every
+                 numeric kernel against a plain loop on each instruction set
+*/
+
+/*********************************************/
+//system includes
+#include <cassert>
+#include <climits>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+/*********************************************/
+//local includes
+#include "Vect.h"
+
+/*********************************************/
+//using declarations
+using std::cout;
+using std::endl;
+using std::ostringstream;
+using std::string;
+
+/*********************************************/
+//prototypes
+
+//print the expected and actual results and stop if they differ
+void printTestResult(const string& test, const string& expected, const ostringstream& actual);
+
+//print the size, capacity and elements of "v" to "out"
+void show(ostringstream& out, const Vect& v);
+
+//how many of the kernels disagree with plain loops on the active instruction set
+int kernelMismatches();
+
+/*********************************************/
+
+int main() {
+    ostringstream output;
+
+    //growth
+    Vect a;
+    show(output, a);
+    printTestResult("default ctor", "0 0 [ ]", output);
+
+    output.str("");
+    for (int i = 0; i < 5; ++i)
+        a.push_back(i);
+    show(output, a);
+    printTestResult("push_back doubles the capacity", "5 8 [ 0 1 2 3 4 ]", output);
+
+    output.str("");
+    a.reserve(20);
+    a.reserve(3); //never shrinks
+    show(output, a);
+    printTestResult("reserve", "5 20 [ 0 1 2 3 4 ]", output);
+
+    output.str("");
+    a.resize(7, 9);
+    show(output, a);
+    a.resize(2);
+    show(output, a);
+    a.pop_back();
+    a.pop_back();
+    a.pop_back(); //empty, does nothing
+    show(output, a);
+    printTestResult("resize and pop_back", "7 20 [ 0 1 2 3 4 9 9 ]2 20 [ 0 1 ]0 20 [ ]", output);
+
+    output.str("");
+    Vect zeros(3);
+    Vect nines(2, 9);
+    show(output, zeros);
+    show(output, nines);
+    printTestResult("size ctors", "3 3 [ 0 0 0 ]2 2 [ 9 9 ]", output);
+
+    //copies are deep and only as big as they need to be
+    output.str("");
+    Vect b;
+    for (int i = 1; i <= 5; ++i)
+        b.push_back(i * 10);
+    Vect c(b);
+    b[0] = -1;
+    show(output, c);
+    Vect d(1, 5);
+    d = c;
+    c.push_back(60);
+    show(output, d);
+    d = d;
+    show(output, d);
+    printTestResult("copy", "5 5 [ 10 20 30 40 50 ]5 5 [ 10 20 30 40 50 ]5 5 [ 10 20 30 40 50 ]", output);
+
+    //moves hand over the array and leave the source empty
+    output.str("");
+    const int* array = c.data();
+    Vect e(std::move(c));
+    output << (e.data() == array) << " ";
+    show(output, c);
+    Vect f;
+    f = std::move(e);
+    output << (f.data() == array) << " ";
+    show(output, e);
+    show(output, f);
+    printTestResult("move", "1 0 0 [ ]1 0 0 [ ]6 10 [ 10 20 30 40 50 60 ]", output);
+
+    //errors
+    output.str("");
+    try {
+        f.at(6);
+    } catch (const std::out_of_range&) {
+        output << "at ";
+    }
+    try {
+        Vect().min();
+    } catch (const std::out_of_range&) {
+        output << "min ";
+    }
+    try {
+        f.dot(d);
+    } catch (const std::invalid_argument&) {
+        output << "dot";
+    }
+    printTestResult("errors", "at min dot", output);
+
+    //the kernels give the same answers as plain loops on every instruction set
+    for (auto isa : {SimdIsa::Isa::Scalar, SimdIsa::Isa::Avx2, SimdIsa::Isa::Avx512}) {
+        SimdIsa::set_isa(isa);
+        output.str("");
+        output << kernelMismatches();
+        printTestResult("kernels, isa " + std::to_string(static_cast<int>(SimdIsa::active_isa())), "0", output);
+    }
+    SimdIsa::set_isa(SimdIsa::detect_isa());
+
+    return EXIT_SUCCESS;
+}
+
+/*********************************************/
+
+void printTestResult(const string& test, const string& expected, const ostringstream& actual) {
+    cout << "Test: " << test << endl;
+    cout << "==========================" << endl;
+    cout << "Expected: " << expected << endl;
+    cout << "Actual  : " << actual.str() << endl;
+    cout << "==========================" << endl << endl;
+
+    //make sure the two results are the same
+    assert(expected == actual.str());
+}
+
+void show(ostringstream& out, const Vect& v) {
+    out << v.sizeOfVect() << " " << v.vectCapacity() << " [ ";
+    for (int x : v)
+        out << x << " ";
+    out << "]";
+}
+
+int kernelMismatches() {
+    int mismatches = 0;
+    std::mt19937 rng(362);
+    //every tail length for both vector widths, then something long
+    for (unsigned n = 0; n <= 1000; n = n == 70 ? 1000 : n + 1) {
+        //small values, then the whole int range so the sums wrap
+        for (int wide = 0; wide < 2; ++wide) {
+            Vect a(n);
+            Vect b(n);
+            for (unsigned i = 0; i < n; ++i) {
+                a[i] = wide ? static_cast<int>(rng()) : static_cast<int>(rng() % 201) - 100;
+                b[i] = wide ? static_cast<int>(rng()) : static_cast<int>(rng() % 201) - 100;
+            }
+            if (wide && n > 2) {
+                a[0] = INT_MIN;
+                a[n - 1] = INT_MAX;
+            }
+
+            //plain loops, wrapping the same way the kernels do
+            unsigned long long dot = 0;
+            for (unsigned i = 0; i < n; ++i)
+                dot += static_cast<unsigned long long>(static_cast<long long>(a[i]) * b[i]);
+            mismatches += a.dot(b) != static_cast<long long>(dot);
+
+            //from one element in, so the loads are not aligned
+            if (n > 1) {
+                unsigned long long offsetDot = dot - static_cast<unsigned long long>(static_cast<long long>(a[0]) * b[0]);
+                mismatches += VectSimd::dot(a.data() + 1, b.data() + 1, n - 1) != static_cast<long long>(offsetDot);
+            }
+
+            if (n > 0) {
+                int lo = a[0];
+                int hi = a[0];
+                for (int x : a) {
+                    lo = x < lo ? x : lo;
+                    hi = x > hi ? x : hi;
+                }
+                mismatches += a.min() != lo;
+                mismatches += a.max() != hi;
+            }
+
+            Vect sums(a);
+            sums.prefixSum();
+            unsigned running = 0;
+            for (unsigned i = 0; i < n; ++i) {
+                running += static_cast<unsigned>(a[i]);
+                mismatches += sums[i] != static_cast<int>(running);
+            }
+        }
+    }
+    return mismatches;
+}